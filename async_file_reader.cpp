@@ -0,0 +1,170 @@
+/*************************************************************************/
+/*  async_file_reader.cpp                                                */
+/*************************************************************************/
+/*                                                                       */
+/*       FMOD Studio module and bindings for the Godot game engine       */
+/*                                                                       */
+/*************************************************************************/
+/* Copyright (c) 2020 Alex Fonseka                                       */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "async_file_reader.h"
+
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/ustring.h"
+
+AsyncFileReader *AsyncFileReader::singleton = nullptr;
+
+void AsyncFileReader::install(FMOD::System *coreSystem) {
+	// no blocking read or seek callbacks, FMOD routes every read through asyncRead when they are null
+	coreSystem->setFileSystem(open, close, nullptr, nullptr, asyncRead, asyncCancel, -1);
+}
+
+void AsyncFileReader::start() {
+	if (thread) return; // already running
+	exitRequested = false;
+	thread = Thread::create(threadFunc, this);
+}
+
+void AsyncFileReader::stop() {
+	if (!thread) return; // not running
+	mutex->lock();
+	exitRequested = true;
+	mutex->unlock();
+	semaphore->post();
+	Thread::wait_to_finish(thread);
+	memdelete(thread);
+	thread = nullptr;
+
+	// FMOD cancels reads before closing a file, so this only triggers if the Core system is still alive
+	mutex->lock();
+	while (!requests.empty()) {
+		FMOD_ASYNCREADINFO *info = requests.front();
+		requests.pop_front();
+		info->done(info, FMOD_ERR_FILE_DISKEJECTED);
+	}
+	mutex->unlock();
+}
+
+FMOD_ASYNCREADINFO *AsyncFileReader::popRequest() {
+	// FMOD raises the priority of reads for streams that are about to starve, serve those first
+	mutex->lock();
+	FMOD_ASYNCREADINFO *info = nullptr;
+	if (!requests.empty()) {
+		auto best = requests.begin();
+		for (auto it = requests.begin(); it != requests.end(); ++it) {
+			if ((*it)->priority > (*best)->priority) best = it;
+		}
+		info = *best;
+		requests.erase(best);
+	}
+	current = info;
+	mutex->unlock();
+	return info;
+}
+
+void AsyncFileReader::serve(FMOD_ASYNCREADINFO *info) {
+	FileAccess *file = (FileAccess *)info->handle;
+	file->seek(info->offset);
+	info->bytesread = file->get_buffer((uint8_t *)info->buffer, info->sizebytes);
+	info->done(info, info->bytesread < info->sizebytes ? FMOD_ERR_FILE_EOF : FMOD_OK);
+}
+
+void AsyncFileReader::threadFunc(void *userdata) {
+	AsyncFileReader *reader = (AsyncFileReader *)userdata;
+	while (true) {
+		// one post per request, plus one to wake up for exit
+		reader->semaphore->wait();
+		reader->mutex->lock();
+		bool exit = reader->exitRequested;
+		reader->mutex->unlock();
+		if (exit) return;
+
+		FMOD_ASYNCREADINFO *info = reader->popRequest();
+		if (!info) continue; // cancelled before the worker got to it
+		serve(info);
+
+		reader->mutex->lock();
+		reader->current = nullptr;
+		reader->mutex->unlock();
+	}
+}
+
+FMOD_RESULT F_CALLBACK AsyncFileReader::open(const char *name, unsigned int *filesize, void **handle, void *userdata) {
+	FileAccess *file = FileAccess::open(String::utf8(name), FileAccess::READ);
+	if (!file) return FMOD_ERR_FILE_NOTFOUND;
+	*filesize = file->get_len();
+	*handle = file;
+	return FMOD_OK;
+}
+
+FMOD_RESULT F_CALLBACK AsyncFileReader::close(void *handle, void *userdata) {
+	// FMOD has cancelled any outstanding read on the file by now
+	FileAccess *file = (FileAccess *)handle;
+	file->close();
+	memdelete(file);
+	return FMOD_OK;
+}
+
+// runs on FMOD's stream and loading threads, only queues the read
+FMOD_RESULT F_CALLBACK AsyncFileReader::asyncRead(FMOD_ASYNCREADINFO *info, void *userdata) {
+	AsyncFileReader *reader = singleton;
+	reader->mutex->lock();
+	reader->requests.push_back(info);
+	reader->mutex->unlock();
+	reader->semaphore->post();
+	return FMOD_OK;
+}
+
+// FMOD must not see info touched after this returns, so a read that is in flight is waited out
+FMOD_RESULT F_CALLBACK AsyncFileReader::asyncCancel(FMOD_ASYNCREADINFO *info, void *userdata) {
+	AsyncFileReader *reader = singleton;
+	reader->mutex->lock();
+	for (auto it = reader->requests.begin(); it != reader->requests.end(); ++it) {
+		if (*it != info) continue;
+		reader->requests.erase(it);
+		reader->mutex->unlock();
+		info->done(info, FMOD_ERR_FILE_DISKEJECTED);
+		return FMOD_OK;
+	}
+	while (reader->current == info) {
+		reader->mutex->unlock();
+		OS::get_singleton()->delay_usec(100);
+		reader->mutex->lock();
+	}
+	reader->mutex->unlock();
+	return FMOD_OK;
+}
+
+AsyncFileReader::AsyncFileReader() {
+	singleton = this;
+	mutex = Mutex::create();
+	semaphore = Semaphore::create();
+}
+
+AsyncFileReader::~AsyncFileReader() {
+	stop();
+	memdelete(semaphore);
+	memdelete(mutex);
+	singleton = nullptr;
+}
@@ -0,0 +1,75 @@
+/*************************************************************************/
+/*  async_file_reader.h                                                  */
+/*************************************************************************/
+/*                                                                       */
+/*       FMOD Studio module and bindings for the Godot game engine       */
+/*                                                                       */
+/*************************************************************************/
+/* Copyright (c) 2020 Alex Fonseka                                       */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include <deque>
+
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+
+#include "api/core/inc/fmod.hpp"
+
+// FMOD file system that serves every Core file read from a Godot worker thread through FileAccess,
+// so streams can be opened from res:// and exported .pck files without blocking FMOD's stream thread.
+// FMOD hands reads over with asyncRead and gets them back through FMOD_ASYNCREADINFO::done.
+class AsyncFileReader {
+	static AsyncFileReader *singleton;
+
+	Thread *thread = nullptr;
+	Mutex *mutex = nullptr;
+	Semaphore *semaphore = nullptr;
+	bool exitRequested = false;
+
+	// reads waiting for the worker, and the one it is serving right now
+	std::deque<FMOD_ASYNCREADINFO *> requests;
+	FMOD_ASYNCREADINFO *current = nullptr;
+
+	static void threadFunc(void *userdata);
+	FMOD_ASYNCREADINFO *popRequest();
+	static void serve(FMOD_ASYNCREADINFO *info);
+
+public:
+	// Installs the callbacks on the Core system, must run before it is initialized
+	void install(FMOD::System *coreSystem);
+
+	void start();
+
+	// Completes queued reads with an error and joins the worker, call after the Core system is released
+	void stop();
+
+	static FMOD_RESULT F_CALLBACK open(const char *name, unsigned int *filesize, void **handle, void *userdata);
+	static FMOD_RESULT F_CALLBACK close(void *handle, void *userdata);
+	static FMOD_RESULT F_CALLBACK asyncRead(FMOD_ASYNCREADINFO *info, void *userdata);
+	static FMOD_RESULT F_CALLBACK asyncCancel(FMOD_ASYNCREADINFO *info, void *userdata);
+
+	AsyncFileReader();
+	~AsyncFileReader();
+};
@@ -29,25 +29,81 @@
 
 #pragma once
 
-#include "core/dictionary.h"
-#include "core/map.h"
+#include <cstdint>
 
 #include "api/studio/inc/fmod_studio.hpp"
 
+#include "spsc_queue.h"
+
 namespace Callbacks {
 
-	struct CallbackInfo {
-		Dictionary markerCallbackInfo;
-		Dictionary beatCallbackInfo;
-		Dictionary soundCallbackInfo;
+	// Plain record of a fired event callback.
+	// Filled in on the Studio update thread and turned into a signal on the game thread.
+	struct CallbackRecord {
+		FMOD_STUDIO_EVENT_CALLBACK_TYPE type = 0;
+		FMOD::Studio::EventInstance *instance = nullptr;
+
+		// user data of the instance when the callback fired
+		void *userData = nullptr;
+
+		// microseconds since engine start, taken when FMOD fired the callback
+		uint64_t timestamp = 0;
+
+		// marker and beat callbacks
+		int position = 0;
+
+		// beat callbacks
+		int bar = 0;
+		int beat = 0;
+		float tempo = 0.f;
+		int timeSignatureUpper = 0;
+		int timeSignatureLower = 0;
+
+		// marker name or sound name
+		char name[256] = {};
+	};
+
+	// Only the Studio update thread produces and only Fmod::update consumes
+	typedef SPSCQueue<CallbackRecord, 1024> CallbackQueue;
+
+	extern CallbackQueue queue;
 
-		bool markerSignalEmitted	= true;
-		bool beatSignalEmitted		= true;
-		bool soundSignalEmitted		= true;
+	// Record that didn't fit into the queue.
+	// STOPPED and DESTROYED records drive instance cleanup, so no record may ever be lost.
+	struct OverflowRecord {
+		CallbackRecord record;
+		OverflowRecord *next = nullptr;
 	};
 
-	extern Mutex *mut;
+	// Newest first. While it isn't empty the queue is bypassed, so records are still dispatched in the order they fired.
+	extern std::atomic<OverflowRecord *> overflow;
+	extern std::atomic<uint32_t> overflowedRecords;
 
 	FMOD_RESULT F_CALLBACK eventCallback(FMOD_STUDIO_EVENT_CALLBACK_TYPE type, FMOD_STUDIO_EVENTINSTANCE *event, void *parameters);
 
+	// Core channel that reached its end
+	struct ChannelEndRecord {
+		FMOD::Channel *channel = nullptr;
+
+		// slot of the channel's handle in Fmod::channels, carried in the channel's user data
+		uint32_t slot = 0;
+	};
+
+	// Only the thread calling System::update produces and only Fmod::update consumes
+	typedef SPSCQueue<ChannelEndRecord, 1024> ChannelEndQueue;
+
+	extern ChannelEndQueue channelEnds;
+
+	// set when a record didn't fit, Fmod::update then checks every channel once
+	extern std::atomic<bool> channelEndsDropped;
+
+	FMOD_RESULT F_CALLBACK channelCallback(FMOD_CHANNELCONTROL *channelcontrol, FMOD_CHANNELCONTROL_TYPE controltype, FMOD_CHANNELCONTROL_CALLBACK_TYPE callbacktype, void *commanddata1, void *commanddata2);
+
+	// File system callbacks that read banks through Godot's FileAccess, so banks can live in res:// and exported .pck files.
+	// The userdata passed to fileOpen is the UTF-8 path of the bank.
+	FMOD_RESULT F_CALLBACK fileOpen(const char *name, unsigned int *filesize, void **handle, void *userdata);
+	FMOD_RESULT F_CALLBACK fileClose(void *handle, void *userdata);
+	FMOD_RESULT F_CALLBACK fileRead(void *handle, void *buffer, unsigned int sizebytes, unsigned int *bytesread, void *userdata);
+	FMOD_RESULT F_CALLBACK fileSeek(void *handle, unsigned int pos, void *userdata);
+
 } // namespace Callbacks
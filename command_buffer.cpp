@@ -0,0 +1,126 @@
+/*************************************************************************/
+/*  command_buffer.cpp                                                   */
+/*************************************************************************/
+/*                                                                       */
+/*       FMOD Studio module and bindings for the Godot game engine       */
+/*                                                                       */
+/*************************************************************************/
+/* Copyright (c) 2020 Alex Fonseka                                       */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "command_buffer.h"
+
+#include "godot_fmod.h"
+
+#include <atomic>
+
+namespace {
+
+	std::atomic<uint64_t> nextBufferId{ 0 };
+
+	inline FMOD_VECTOR toFmodVector(const Vector3 &vec) {
+		FMOD_VECTOR fv;
+		fv.x = vec.x;
+		fv.y = vec.y;
+		fv.z = vec.z;
+		return fv;
+	}
+
+} // namespace
+
+FmodCommandBuffer::FmodCommandBuffer() :
+		bufferId(nextBufferId.fetch_add(1, std::memory_order_relaxed)) {
+}
+
+void FmodCommandBuffer::playOneShot(const StringName &eventPath, Vector3 position) {
+	FmodCommand command;
+	command.type = FmodCommand::PLAY_ONE_SHOT;
+	command.eventPath = eventPath;
+	command.attributes.position = toFmodVector(position);
+	command.attributes.velocity = toFmodVector(Vector3(0, 0, 0));
+	command.attributes.forward = toFmodVector(Vector3(0, 0, 1));
+	command.attributes.up = toFmodVector(Vector3(0, 1, 0));
+	commands.push_back(command);
+}
+
+void FmodCommandBuffer::start(uint64_t instanceId) {
+	FmodCommand command;
+	command.type = FmodCommand::START;
+	command.instanceId = instanceId;
+	commands.push_back(command);
+}
+
+void FmodCommandBuffer::stop(uint64_t instanceId, int stopMode) {
+	FmodCommand command;
+	command.type = FmodCommand::STOP;
+	command.instanceId = instanceId;
+	command.stopMode = stopMode;
+	commands.push_back(command);
+}
+
+void FmodCommandBuffer::setParameterByToken(uint64_t instanceId, int token, float value) {
+	FmodCommand command;
+	command.type = FmodCommand::SET_PARAMETER;
+	command.instanceId = instanceId;
+	command.token = token;
+	command.value = value;
+	commands.push_back(command);
+}
+
+void FmodCommandBuffer::set3DAttributes(uint64_t instanceId, Vector3 forward, Vector3 position, Vector3 up, Vector3 velocity) {
+	FmodCommand command;
+	command.type = FmodCommand::SET_3D_ATTRIBUTES;
+	command.instanceId = instanceId;
+	command.attributes.forward = toFmodVector(forward);
+	command.attributes.position = toFmodVector(position);
+	command.attributes.up = toFmodVector(up);
+	command.attributes.velocity = toFmodVector(velocity);
+	commands.push_back(command);
+}
+
+int FmodCommandBuffer::getCommandCount() {
+	return commands.size();
+}
+
+void FmodCommandBuffer::clear() {
+	commands.clear();
+}
+
+void FmodCommandBuffer::submit() {
+	if (commands.empty()) return;
+	FmodCommandBatch *batch = new FmodCommandBatch();
+	batch->commands.swap(commands);
+	batch->bufferId = bufferId;
+	batch->submitIndex = submitCount++;
+	Fmod::getSingleton()->submitCommandBatch(batch);
+}
+
+void FmodCommandBuffer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("play_one_shot", "event_path", "position"), &FmodCommandBuffer::playOneShot);
+	ClassDB::bind_method(D_METHOD("event_start", "handle"), &FmodCommandBuffer::start);
+	ClassDB::bind_method(D_METHOD("event_stop", "handle", "stop_mode"), &FmodCommandBuffer::stop);
+	ClassDB::bind_method(D_METHOD("event_set_parameter_by_token", "handle", "token", "value"), &FmodCommandBuffer::setParameterByToken);
+	ClassDB::bind_method(D_METHOD("event_set_3D_attributes", "handle", "forward", "position", "up", "velocity"), &FmodCommandBuffer::set3DAttributes);
+	ClassDB::bind_method(D_METHOD("get_command_count"), &FmodCommandBuffer::getCommandCount);
+	ClassDB::bind_method(D_METHOD("clear"), &FmodCommandBuffer::clear);
+	ClassDB::bind_method(D_METHOD("submit"), &FmodCommandBuffer::submit);
+}
@@ -0,0 +1,95 @@
+/*************************************************************************/
+/*  command_buffer.h                                                     */
+/*************************************************************************/
+/*                                                                       */
+/*       FMOD Studio module and bindings for the Godot game engine       */
+/*                                                                       */
+/*************************************************************************/
+/* Copyright (c) 2020 Alex Fonseka                                       */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "core/math/vector3.h"
+#include "core/reference.h"
+#include "core/string_name.h"
+
+#include "api/core/inc/fmod.hpp"
+
+// One operation recorded by an FmodCommandBuffer, executed on the game thread during Fmod::update
+struct FmodCommand {
+	enum Type {
+		PLAY_ONE_SHOT,
+		START,
+		STOP,
+		SET_PARAMETER,
+		SET_3D_ATTRIBUTES
+	};
+	Type type = PLAY_ONE_SHOT;
+	uint64_t instanceId = 0;
+	StringName eventPath;
+	int stopMode = 0;
+	int token = 0;
+	float value = 0.0f;
+	FMOD_3D_ATTRIBUTES attributes;
+};
+
+// Commands handed over by one submit, linked into Fmod's lock-free list of pending batches
+struct FmodCommandBatch {
+	std::vector<FmodCommand> commands;
+
+	// Batches run ordered by the buffer that submitted them, then by that buffer's submits
+	uint64_t bufferId = 0;
+	uint64_t submitIndex = 0;
+
+	FmodCommandBatch *next = nullptr;
+};
+
+// Records audio operations on any thread for Fmod::update to execute on the game thread.
+// A buffer must only be used by one thread at a time, give each worker thread its own.
+class FmodCommandBuffer : public Reference {
+	GDCLASS(FmodCommandBuffer, Reference);
+
+	std::vector<FmodCommand> commands;
+
+	// Buffers are numbered in creation order, which orders their batches within one update
+	uint64_t bufferId;
+	uint64_t submitCount = 0;
+
+protected:
+	static void _bind_methods();
+
+public:
+	FmodCommandBuffer();
+
+	void playOneShot(const StringName &eventPath, Vector3 position);
+	void start(uint64_t instanceId);
+	void stop(uint64_t instanceId, int stopMode);
+	void setParameterByToken(uint64_t instanceId, int token, float value);
+	void set3DAttributes(uint64_t instanceId, Vector3 forward, Vector3 position, Vector3 up, Vector3 velocity);
+	int getCommandCount();
+	void clear();
+	void submit();
+};
@@ -29,79 +29,179 @@
 
 #include "godot_fmod.h"
 
-Mutex *Callbacks::mut;
+Callbacks::CallbackQueue Callbacks::queue;
+std::atomic<Callbacks::OverflowRecord *> Callbacks::overflow{ nullptr };
+std::atomic<uint32_t> Callbacks::overflowedRecords{ 0 };
+Callbacks::ChannelEndQueue Callbacks::channelEnds;
+std::atomic<bool> Callbacks::channelEndsDropped{ false };
 
 Fmod *Fmod::singleton = nullptr;
 
 void Fmod::init(int numOfChannels, int studioFlags, int flags) {
 	// initialize FMOD Studio and FMOD Core System with provided flags
+	coreInitFlags = flags;
+	fileReader.start();
 	if (checkErrors(system->initialize(numOfChannels, studioFlags, flags, nullptr))) {
 		print_line("FMOD Sound System: Successfully initialized");
 		if (studioFlags & FMOD_STUDIO_INIT_LIVEUPDATE)
 			print_line("FMOD Sound System: Live update enabled!");
+		// size instance bookkeeping for as many instances as there are voices up front
+		eventInfoPool.reserve(numOfChannels);
+		events.reserve(numOfChannels);
 	} else
 		print_error("FMOD Sound System: Failed to initialize :|");
 }
 
 void Fmod::update() {
-	// clean up one shots
-	for (auto e = events.front(); e; e = e->next()) {
-		FMOD::Studio::EventInstance *eventInstance = e->get();
-		EventInfo *eventInfo = getEventInfo(eventInstance);
-		if (eventInfo->gameObj) {
-			if (isNull(eventInfo->gameObj)) {
-				FMOD_STUDIO_STOP_MODE m = FMOD_STUDIO_STOP_IMMEDIATE;
-				checkErrors(eventInstance->stop(m));
-				releaseOneEvent(eventInstance);
-				continue;
-			}
-			updateInstance3DAttributes(eventInstance, eventInfo->gameObj);
-		}
-	}
+	// dispatch queued callbacks, this also reaps one-shots that stopped and instances that were destroyed
+	runCallbacks();
+
+	// run what worker threads recorded since the last update
+	executeCommandBatches();
+
+	// index and signal banks that finished loading in the background
+	updatePendingBanks();
+
+	// play and signal sounds that finished opening in the background
+	updatePendingSounds();
 
-	// clean up invalid channel references
+	// keep cached sample data within the budget
+	evictSampleData();
+
+	// update instances attached to nodes
+	updateAttachedInstances();
+
+	// drop the handles of channels that ended and signal them
 	clearChannelRefs();
 
 	// update listener position
 	setListenerAttributes();
 
-	// if events are subscribed to callbacks, update them
-	runCallbacks();
+	// the update thread calls system->update() itself, it only needs this frame's transforms
+	if (updateThreadRunning.load(std::memory_order_relaxed)) {
+		submitCommands();
+		return;
+	}
 
 	// finally, dispatch an update call to FMOD
 	checkErrors(system->update());
 }
 
+void Fmod::updateAttachedInstances() {
+	// stop instances whose node was freed
+	// walk backwards since detaching an instance moves the last one into its place
+	for (int i = (int)attachedEvents.size() - 1; i >= 0; i--) {
+		EventInfo *eventInfo = attachedEvents[i];
+		if (isNull(eventInfo->gameObj)) {
+			FMOD_STUDIO_STOP_MODE m = FMOD_STUDIO_STOP_IMMEDIATE;
+			checkErrors(eventInfo->instance->stop(m));
+			// pooled instances are recycled by their STOPPED callback instead
+			if (eventInfo->pool) detachEvent(eventInfo);
+			else releaseOneEvent(eventInfo->instance);
+		}
+	}
+
+	for (size_t i = 0; i < attachedEvents.size(); i++) {
+		EventInfo *eventInfo = attachedEvents[i];
+		FMOD_3D_ATTRIBUTES attr = getNodeAttributes(eventInfo->gameObj, &eventInfo->motion);
+		toFmodUnits(attr);
+		// skip emitters that haven't moved since the last update
+		if (eventInfo->attributesSent && std::memcmp(&attr, &eventInfo->sentAttributes, sizeof(attr)) == 0) continue;
+		if (updateThreadRunning.load(std::memory_order_relaxed)) {
+			UpdateCommand command;
+			command.type = UpdateCommand::SET_EVENT_ATTRIBUTES;
+			command.instance = eventInfo->instance;
+			command.eventInfo = eventInfo;
+			command.attributes = attr;
+			pendingCommands.push_back(command);
+			eventInfo->sentAttributes = attr;
+			eventInfo->attributesSent = true;
+		} else if (checkErrors(eventInfo->instance->set3DAttributes(&attr))) {
+			eventInfo->sentAttributes = attr;
+			eventInfo->attributesSent = true;
+		}
+	}
+}
+
 void Fmod::updateInstance3DAttributes(FMOD::Studio::EventInstance *instance, Object *o) {
 	// try to set 3D attributes
 	if (instance && !isNull(o)) {
-		CanvasItem *ci = Object::cast_to<CanvasItem>(o);
-		if (ci != nullptr) { // GameObject is 2D
-			Transform2D t2d = ci->get_transform();
-			Vector2 posVector = t2d.get_origin() / distanceScale;
-			// in 2D, the distance is measured in pixels
-			// TODO: Revise the set3DAttributes call. In 2D, the emitters must directly face the listener.
-			Vector3 pos(posVector.x, 0.0f, posVector.y),
-					up(0, 1, 0), forward(0, 0, 1), vel(0, 0, 0); // TODO: add doppler
-			FMOD_3D_ATTRIBUTES attr = get3DAttributes(toFmodVector(pos), toFmodVector(up), toFmodVector(forward), toFmodVector(vel));
-			checkErrors(instance->set3DAttributes(&attr));
-		} else { // GameObject is 3D
-			// needs testing
-			Spatial *s = Object::cast_to<Spatial>(o);
-			Transform t = s->get_transform();
-			Vector3 pos = t.get_origin() / distanceScale;
-			Vector3 up = t.get_basis().elements[1];
-			Vector3 forward = t.get_basis().elements[2];
-			Vector3 vel(0, 0, 0);
-			FMOD_3D_ATTRIBUTES attr = get3DAttributes(toFmodVector(pos), toFmodVector(up), toFmodVector(forward), toFmodVector(vel));
-			checkErrors(instance->set3DAttributes(&attr));
-		}
+		FMOD_3D_ATTRIBUTES attr = getNodeAttributes(o, nullptr);
+		toFmodUnits(attr);
+		checkErrors(instance->set3DAttributes(&attr));
 	}
 }
 
+FMOD_3D_ATTRIBUTES Fmod::getNodeAttributes(Object *o, MotionHistory *motion) {
+	// positions are in engine units, toFmodUnits converts them afterwards
+	FMOD_3D_ATTRIBUTES attr;
+	Vector3 pos;
+	CanvasItem *ci = Object::cast_to<CanvasItem>(o);
+	if (ci != nullptr) { // GameObject is 2D
+		Transform2D t2d = ci->get_global_transform();
+		Vector2 posVector = t2d.get_origin();
+		// in 2D, the distance is measured in pixels
+		// TODO: Revise the set3DAttributes call. In 2D, the emitters must directly face the listener.
+		pos = Vector3(posVector.x, 0.0f, posVector.y);
+		attr.up = toFmodVector(Vector3(0, 1, 0));
+		attr.forward = toFmodVector(Vector3(0, 0, 1));
+	} else { // GameObject is 3D
+		// needs testing
+		Spatial *s = Object::cast_to<Spatial>(o);
+		Transform t = s->get_global_transform();
+		pos = t.get_origin();
+		attr.up = toFmodVector(t.get_basis().elements[1]);
+		attr.forward = toFmodVector(t.get_basis().elements[2]);
+	}
+	attr.position = toFmodVector(pos);
+	attr.velocity = toFmodVector(getNodeVelocity(o, pos, motion));
+	return attr;
+}
+
+void Fmod::toFmodUnits(FMOD_3D_ATTRIBUTES &attr) {
+	float factor = 1.0f / distanceScale;
+	attr.position.x *= factor;
+	attr.position.y *= factor;
+	attr.position.z *= factor;
+	attr.velocity.x *= factor;
+	attr.velocity.y *= factor;
+	attr.velocity.z *= factor;
+}
+
+Vector3 Fmod::getNodeVelocity(Object *o, const Vector3 &position, MotionHistory *motion) {
+	// physics bodies already know their velocity
+	RigidBody *rb = Object::cast_to<RigidBody>(o);
+	if (rb != nullptr) return rb->get_linear_velocity();
+	RigidBody2D *rb2d = Object::cast_to<RigidBody2D>(o);
+	if (rb2d != nullptr) {
+		Vector2 v = rb2d->get_linear_velocity();
+		return Vector3(v.x, 0.0f, v.y);
+	}
+
+	// otherwise derive it from the distance moved since the previous update
+	if (motion == nullptr) return Vector3(0, 0, 0);
+	uint64_t now = OS::get_singleton()->get_ticks_usec();
+	if (motion->lastUsec == 0) {
+		motion->velocity = Vector3(0, 0, 0);
+	} else if (now > motion->lastUsec) {
+		float dt = (now - motion->lastUsec) / 1000000.0f;
+		motion->velocity = (position - motion->lastPosition) / dt;
+	}
+	motion->lastPosition = position;
+	motion->lastUsec = now;
+	return motion->velocity;
+}
+
 void Fmod::shutdown() {
+	stopUpdateThread();
 	checkErrors(system->unloadAll());
 	checkErrors(system->release());
+	// every file is closed once the Core system is gone
+	fileReader.stop();
+	// and no bank points at its memory anymore
+	for (auto e = bankMemory.front(); e; e = e->next())
+		memfree(e->get());
+	bankMemory.clear();
 }
 
 void Fmod::setListenerAttributes() {
@@ -115,35 +215,191 @@ void Fmod::setListenerAttributes() {
 
 	clearNullListeners();
 
-	for (int i = 0; i < listeners.size(); i++) {
-		auto listener = listeners[i];
-
-		CanvasItem *ci = Object::cast_to<CanvasItem>(listener.gameObj);
-		if (ci != nullptr) { // Listener is in 2D space
-			Transform2D t2d = ci->get_transform();
-			Vector2 posVector = t2d.get_origin() / distanceScale;
-			// in 2D, the distance is measured in pixels
-			// TODO: Revise the set3DAttributes call. In 2D, the listener must be a few units away from
-			// the emitters (or the screen) and must face them directly.
-			Vector3 pos(posVector.x, 0.0f, posVector.y),
-					up(0, 1, 0), forward(0, 0, 1), vel(0, 0, 0); // TODO: add doppler
-			FMOD_3D_ATTRIBUTES attr = get3DAttributes(toFmodVector(pos), toFmodVector(up), toFmodVector(forward), toFmodVector(vel));
-			if (!listener.listenerLock) checkErrors(system->setListenerAttributes(i, &attr));
-
-		} else { // Listener is in 3D space
-			// needs testing
-			Spatial *s = Object::cast_to<Spatial>(listener.gameObj);
-			Transform t = s->get_transform();
-			Vector3 pos = t.get_origin() / distanceScale;
-			Vector3 up = t.get_basis().elements[1];
-			Vector3 forward = t.get_basis().elements[2];
-			Vector3 vel(0, 0, 0);
-			FMOD_3D_ATTRIBUTES attr = get3DAttributes(toFmodVector(pos), toFmodVector(up), toFmodVector(forward), toFmodVector(vel));
-			if (!listener.listenerLock) checkErrors(system->setListenerAttributes(i, &attr));
+	// in 2D the listener must be a few units away from the emitters (or the screen) and must face them directly
+	// TODO: Revise the set3DAttributes call for 2D listeners.
+	for (int i = 0; i < (int)listeners.size(); i++) {
+		if (listeners[i].listenerLock) continue;
+		FMOD_3D_ATTRIBUTES attr = getNodeAttributes(listeners[i].gameObj, &listeners[i].motion);
+		toFmodUnits(attr);
+		if (updateThreadRunning.load(std::memory_order_relaxed)) {
+			UpdateCommand command;
+			command.type = UpdateCommand::SET_LISTENER_ATTRIBUTES;
+			command.listenerIndex = i;
+			command.attributes = attr;
+			pendingCommands.push_back(command);
+		} else {
+			checkErrors(system->setListenerAttributes(i, &attr));
 		}
 	}
 }
 
+void Fmod::submitCommandBatch(FmodCommandBatch *batch) {
+	// push onto the pending list, the game thread takes the whole list at once so this never blocks
+	FmodCommandBatch *head = commandBatches.load(std::memory_order_relaxed);
+	do {
+		batch->next = head;
+	} while (!commandBatches.compare_exchange_weak(head, batch, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void Fmod::executeCommandBatches() {
+	FmodCommandBatch *batch = commandBatches.exchange(nullptr, std::memory_order_acquire);
+	if (!batch) return;
+
+	// the push order depends on thread timing, so order by buffer and submit instead
+	executingBatches.clear();
+	for (; batch; batch = batch->next)
+		executingBatches.push_back(batch);
+	std::sort(executingBatches.begin(), executingBatches.end(), [](const FmodCommandBatch *a, const FmodCommandBatch *b) {
+		if (a->bufferId != b->bufferId) return a->bufferId < b->bufferId;
+		return a->submitIndex < b->submitIndex;
+	});
+
+	for (size_t i = 0; i < executingBatches.size(); i++) {
+		const std::vector<FmodCommand> &commands = executingBatches[i]->commands;
+		for (size_t j = 0; j < commands.size(); j++)
+			executeCommand(commands[j]);
+		delete executingBatches[i];
+	}
+	executingBatches.clear();
+}
+
+void Fmod::executeCommand(const FmodCommand &command) {
+	if (command.type == FmodCommand::PLAY_ONE_SHOT) {
+		playOneShotAt(command.eventPath, command.attributes);
+		return;
+	}
+
+	// the instance may have been released since the command was recorded
+	EventInfo *eventInfo = getEventInfo(command.instanceId);
+	if (!eventInfo) return;
+	FMOD::Studio::EventInstance *instance = eventInfo->instance;
+	switch (command.type) {
+		case FmodCommand::START:
+			checkErrors(instance->start());
+			break;
+		case FmodCommand::STOP:
+			checkErrors(instance->stop(static_cast<FMOD_STUDIO_STOP_MODE>(command.stopMode)));
+			break;
+		case FmodCommand::SET_PARAMETER: {
+			FMOD_STUDIO_PARAMETER_ID id;
+			if (getParameterId(command.token, id)) checkErrors(instance->setParameterByID(id, command.value));
+		} break;
+		case FmodCommand::SET_3D_ATTRIBUTES: {
+			// make sure the attached node's attributes are sent again on the next update
+			eventInfo->attributesSent = false;
+			// same units as event_set_3D_attributes, which passes its vectors to FMOD unscaled
+			checkErrors(instance->set3DAttributes(&command.attributes));
+		} break;
+		default:
+			break;
+	}
+}
+
+void Fmod::playOneShotAt(const StringName &eventPath, const FMOD_3D_ATTRIBUTES &attributes) {
+	DescriptionInfo *descInfo = findDescription(eventPath);
+	OneShotLimits limits;
+	if (!descInfo || !admitOneShot(descInfo, nullptr, limits)) return;
+	FMOD::Studio::EventInstance *instance = createOneShot(descInfo, limits, nullptr);
+	if (instance) {
+		FMOD_3D_ATTRIBUTES attr = attributes;
+		toFmodUnits(attr);
+		checkErrors(instance->set3DAttributes(&attr));
+		checkErrors(instance->start());
+		// pooled and limited instances are recycled or released once they stop
+		if (!getEventInfo(instance)) checkErrors(instance->release());
+	}
+}
+
+void Fmod::startUpdateThread(int updatesPerSecond) {
+	if (updateThread) return; // already running
+	if (coreInitFlags & FMOD_INIT_THREAD_UNSAFE) {
+		print_error("FMOD Sound System: The update thread needs FMOD to be initialized without FMOD_INIT_THREAD_UNSAFE");
+		return;
+	}
+	if (updatesPerSecond <= 0) {
+		print_error("FMOD Sound System: The update thread needs at least one update per second");
+		return;
+	}
+	updateThreadRate = updatesPerSecond;
+	updateThreadRunning.store(true, std::memory_order_release);
+	updateThread = Thread::create(updateThreadLoop, this);
+}
+
+void Fmod::stopUpdateThread() {
+	if (!updateThread) return; // not running
+	updateThreadRunning.store(false, std::memory_order_release);
+	Thread::wait_to_finish(updateThread);
+	memdelete(updateThread);
+	updateThread = nullptr;
+	// the thread is gone, so whatever it didn't get to is applied from here
+	applyCommands();
+}
+
+bool Fmod::isUpdateThreadRunning() {
+	return updateThread != nullptr;
+}
+
+void Fmod::updateThreadLoop(void *userdata) {
+	Fmod *fmod = (Fmod *)userdata;
+	OS *os = OS::get_singleton();
+	uint64_t interval = 1000000 / fmod->updateThreadRate;
+	uint64_t next = os->get_ticks_usec();
+	while (fmod->updateThreadRunning.load(std::memory_order_acquire)) {
+		fmod->applyCommands();
+		fmod->checkErrors(fmod->system->update());
+
+		next += interval;
+		uint64_t now = os->get_ticks_usec();
+		if (next > now) {
+			os->delay_usec(next - now);
+		} else {
+			// fell behind, carry on from now instead of running a burst of updates to catch up
+			next = now;
+		}
+	}
+}
+
+void Fmod::submitCommands() {
+	if (pendingCommands.empty()) return;
+	commandMutex->lock();
+	for (size_t i = 0; i < pendingCommands.size(); i++) {
+		const UpdateCommand &command = pendingCommands[i];
+		bool isEvent = command.type == UpdateCommand::SET_EVENT_ATTRIBUTES;
+		int &slot = isEvent ? command.eventInfo->submittedCommand : listeners[command.listenerIndex].submittedCommand;
+		// the update thread fell behind, only the latest attributes of each target are worth applying
+		if (slot >= 0 && slot < (int)submittedCommands.size()) {
+			const UpdateCommand &submitted = submittedCommands[slot];
+			if (submitted.type == command.type && (isEvent ? submitted.instance == command.instance : submitted.listenerIndex == command.listenerIndex)) {
+				submittedCommands[slot] = command;
+				continue;
+			}
+		}
+		slot = submittedCommands.size();
+		submittedCommands.push_back(command);
+	}
+	commandMutex->unlock();
+	pendingCommands.clear();
+}
+
+void Fmod::applyCommands() {
+	// swapping keeps both buffers' capacity, so handing commands over doesn't allocate
+	commandMutex->lock();
+	applyingCommands.swap(submittedCommands);
+	commandMutex->unlock();
+
+	for (size_t i = 0; i < applyingCommands.size(); i++) {
+		UpdateCommand &command = applyingCommands[i];
+		if (command.type == UpdateCommand::SET_EVENT_ATTRIBUTES) {
+			// the instance may have been released on the game thread since the command was queued
+			if (!command.instance->isValid()) continue;
+			checkErrors(command.instance->set3DAttributes(&command.attributes));
+		} else {
+			checkErrors(system->setListenerAttributes(command.listenerIndex, &command.attributes));
+		}
+	}
+	applyingCommands.clear();
+}
+
 void Fmod::addListener(Object *gameObj) {
 	if (listeners.size() == FMOD_MAX_LISTENERS) {
 		print_error("FMOD Sound System: Could not add listener. System already at max listeners.");
@@ -171,37 +427,102 @@ void Fmod::setSoftwareFormat(int sampleRate, int speakerMode, int numRawSpeakers
 	checkErrors(coreSystem->setSoftwareFormat(sampleRate, m, numRawSpeakers));
 }
 
-void Fmod::setGlobalParameterByName(const String &parameterName, float value) {
-	checkErrors(system->setParameterByName(parameterName.ascii().get_data(), value));
+void Fmod::setGlobalParameterByName(const StringName &parameterName, float value) {
+	setGlobalParameterByToken(getGlobalParameterToken(parameterName), value);
+}
+
+float Fmod::getGlobalParameterByName(const StringName &parameterName) {
+	return getGlobalParameterByToken(getGlobalParameterToken(parameterName));
 }
 
-float Fmod::getGlobalParameterByName(const String &parameterName) {
+int Fmod::getGlobalParameterToken(const StringName &parameterName) {
+	return resolveParameterToken(nullptr, parameterName);
+}
+
+void Fmod::setGlobalParameterByToken(int token, float value) {
+	FMOD_STUDIO_PARAMETER_ID id;
+	if (!getParameterId(token, id)) return;
+	checkErrors(system->setParameterByID(id, value));
+}
+
+float Fmod::getGlobalParameterByToken(int token) {
+	FMOD_STUDIO_PARAMETER_ID id;
 	float value = 0.f;
-	checkErrors(system->getParameterByName(parameterName.ascii().get_data(), &value));
+	if (!getParameterId(token, id)) return value;
+	checkErrors(system->getParameterByID(id, &value));
 	return value;
 }
 
-void Fmod::setGlobalParameterByID(const Array &idPair, float value) {
-	if (idPair.size() != 2) {
-		print_error("FMOD Sound System: Invalid parameter ID");
-		return;
+void Fmod::setGlobalParametersByTokens(const PoolIntArray &tokens, const PoolRealArray &values) {
+	if (!stageParameterBatch(tokens, values)) return;
+	checkErrors(system->setParametersByIDs(batchIds.data(), batchValues.data(), (int)batchIds.size()));
+}
+
+bool Fmod::stageParameterBatch(const PoolIntArray &tokens, const PoolRealArray &values) {
+	if (tokens.size() != values.size()) {
+		print_error("FMOD Sound System: Expected one value per parameter token");
+		return false;
 	}
-	FMOD_STUDIO_PARAMETER_ID id;
-	id.data1 = idPair[0];
-	id.data2 = idPair[1];
-	checkErrors(system->setParameterByID(id, value));
+	int count = tokens.size();
+	if (count == 0) return false;
+	PoolIntArray::Read t = tokens.read();
+	PoolRealArray::Read v = values.read();
+	batchIds.resize(count);
+	batchValues.resize(count);
+	for (int i = 0; i < count; i++) {
+		if (!getParameterId(t[i], batchIds[i])) return false;
+		batchValues[i] = v[i];
+	}
+	return true;
 }
 
-float Fmod::getGlobalParameterByID(const Array &idPair) {
-	if (idPair.size() != 2) {
-		print_error("FMOD Sound System: Invalid parameter ID");
-		return -1.f;
+int Fmod::resolveParameterToken(DescriptionInfo *descInfo, const StringName &parameterName) {
+	// StringNames compare by pointer, so this is a handful of integer compares per call
+	std::vector<ParameterToken> &tokens = descInfo ? descInfo->parameterTokens : globalParameterTokens;
+	for (size_t i = 0; i < tokens.size(); i++) {
+		if (tokens[i].name == parameterName) return tokens[i].token;
 	}
-	FMOD_STUDIO_PARAMETER_ID id;
-	id.data1 = idPair[0];
-	id.data2 = idPair[1];
+
+	// first use of this name, ask FMOD once
+	FMOD_STUDIO_PARAMETER_DESCRIPTION pDesc;
+	CharString name = String(parameterName).utf8();
+	FMOD_RESULT result = descInfo ? descInfo->desc->getParameterDescriptionByName(name.get_data(), &pDesc) : system->getParameterDescriptionByName(name.get_data(), &pDesc);
+	ParameterToken parameterToken;
+	parameterToken.name = parameterName;
+	if (!checkErrors(result)) {
+		// remember the failure as token 0 so an unknown name is only reported once
+		tokens.push_back(parameterToken);
+		return 0;
+	}
+	// IDs don't change when a bank is unloaded and loaded again, so its events share the earlier tokens
+	uint64_t idKey = packParameterId(pDesc.id);
+	if (!parameterTokensById.lookup(idKey, parameterToken.token)) {
+		parameterIds.push_back(pDesc.id);
+		parameterToken.token = parameterIds.size();
+		parameterTokensById.set(idKey, parameterToken.token);
+	}
+	tokens.push_back(parameterToken);
+	return parameterToken.token;
+}
+
+bool Fmod::getParameterId(int token, FMOD_STUDIO_PARAMETER_ID &id) {
+	// 0 is what a failed name lookup returns, that failure was already reported
+	if (token == 0) return false;
+	if (token < 0 || token > (int)parameterIds.size()) {
+		print_error("FMOD Sound System: Invalid parameter token");
+		return false;
+	}
+	id = parameterIds[token - 1];
+	return true;
+}
+
+void Fmod::setGlobalParameterByID(uint64_t parameterId, float value) {
+	checkErrors(system->setParameterByID(unpackParameterId(parameterId), value));
+}
+
+float Fmod::getGlobalParameterByID(uint64_t parameterId) {
 	float value = -1.f;
-	checkErrors(system->getParameterByID(id, &value));
+	checkErrors(system->getParameterByID(unpackParameterId(parameterId), &value));
 	return value;
 }
 
@@ -210,8 +531,7 @@ Dictionary Fmod::getGlobalParameterDescByName(const String &parameterName) {
 	FMOD_STUDIO_PARAMETER_DESCRIPTION pDesc;
 	if (checkErrors(system->getParameterDescriptionByName(parameterName.ascii().get_data(), &pDesc))) {
 		paramDesc["name"] = String(pDesc.name);
-		paramDesc["id_first"] = pDesc.id.data1;
-		paramDesc["id_second"] = pDesc.id.data2;
+		paramDesc["id"] = packParameterId(pDesc.id);
 		paramDesc["minimum"] = pDesc.minimum;
 		paramDesc["maximum"] = pDesc.maximum;
 		paramDesc["default_value"] = pDesc.defaultvalue;
@@ -220,20 +540,12 @@ Dictionary Fmod::getGlobalParameterDescByName(const String &parameterName) {
 	return paramDesc;
 }
 
-Dictionary Fmod::getGlobalParameterDescByID(const Array &idPair) {
-	if (idPair.size() != 2) {
-		print_error("FMOD Sound System: Invalid parameter ID");
-		return Dictionary();
-	}
+Dictionary Fmod::getGlobalParameterDescByID(uint64_t parameterId) {
 	Dictionary paramDesc;
-	FMOD_STUDIO_PARAMETER_ID id;
-	id.data1 = idPair[0];
-	id.data2 = idPair[1];
 	FMOD_STUDIO_PARAMETER_DESCRIPTION pDesc;
-	if (checkErrors(system->getParameterDescriptionByID(id, &pDesc))) {
+	if (checkErrors(system->getParameterDescriptionByID(unpackParameterId(parameterId), &pDesc))) {
 		paramDesc["name"] = String(pDesc.name);
-		paramDesc["id_first"] = pDesc.id.data1;
-		paramDesc["id_second"] = pDesc.id.data2;
+		paramDesc["id"] = packParameterId(pDesc.id);
 		paramDesc["minimum"] = pDesc.minimum;
 		paramDesc["maximum"] = pDesc.maximum;
 		paramDesc["default_value"] = pDesc.defaultvalue;
@@ -257,8 +569,7 @@ Array Fmod::getGlobalParameterDescList() {
 		auto pDesc = descList[i];
 		Dictionary paramDesc;
 		paramDesc["name"] = String(pDesc.name);
-		paramDesc["id_first"] = pDesc.id.data1;
-		paramDesc["id_second"] = pDesc.id.data2;
+		paramDesc["id"] = packParameterId(pDesc.id);
 		paramDesc["minimum"] = pDesc.minimum;
 		paramDesc["maximum"] = pDesc.maximum;
 		paramDesc["default_value"] = pDesc.defaultvalue;
@@ -337,9 +648,89 @@ Dictionary Fmod::getPerformanceData() {
 	filePerfData["other_bytes_read"] = (uint64_t)otherBytesRead;
 	performanceData["file"] = filePerfData;
 
+	// get the sample data cache usage
+	Dictionary cachePerfData;
+	cachePerfData["budget"] = sampleDataBudget;
+	cachePerfData["cached_descriptions"] = sampleCache.size();
+	cachePerfData["hits"] = sampleCacheHits;
+	cachePerfData["misses"] = sampleCacheMisses;
+	cachePerfData["evictions"] = sampleCacheEvictions;
+	performanceData["sample_cache"] = cachePerfData;
+
+	// get the one-shots that were never created
+	Dictionary cullingPerfData;
+	cullingPerfData["culled_by_distance"] = culledByDistance;
+	cullingPerfData["culled_by_limit"] = culledByLimit;
+	cullingPerfData["stolen"] = instancesStolen;
+	performanceData["culling"] = cullingPerfData;
+
 	return performanceData;
 }
 
+void Fmod::setSampleDataBudget(int bytes) {
+	sampleDataBudget = bytes;
+	sampleCacheBusy = false;
+	if (sampleDataBudget > 0) return;
+	// without a budget the cache is off, hand the sample data it loaded back to FMOD
+	for (auto e = sampleCache.front(); e; e = e->next()) {
+		checkErrors(e->get()->desc->unloadSampleData());
+		e->get()->sampleCacheEntry = nullptr;
+	}
+	sampleCache.clear();
+	evictingDesc = nullptr;
+}
+
+int Fmod::getSampleDataBudget() {
+	return sampleDataBudget;
+}
+
+void Fmod::setStreamBufferSize(int bytes) {
+	// only applies to streams opened after the call
+	checkErrors(coreSystem->setStreamBufferSize(bytes, FMOD_TIMEUNIT_RAWBYTES));
+}
+
+void Fmod::touchSampleData(DescriptionInfo *descInfo) {
+	if (!descInfo) return;
+	sampleCacheBusy = false;
+	if (descInfo->sampleCacheEntry) {
+		sampleCacheHits++;
+		sampleCache.move_to_back(descInfo->sampleCacheEntry);
+		return;
+	}
+	sampleCacheMisses++;
+	if (checkErrors(descInfo->desc->loadSampleData()))
+		descInfo->sampleCacheEntry = sampleCache.push_back(descInfo);
+}
+
+void Fmod::evictSampleData() {
+	if (sampleDataBudget <= 0 || sampleCache.empty() || sampleCacheBusy) return;
+
+	// unloading happens in the background, wait for the last eviction to show up in the memory usage
+	if (evictingDesc) {
+		FMOD_STUDIO_LOADING_STATE state;
+		if (evictingDesc->getSampleLoadingState(&state) == FMOD_OK && state == FMOD_STUDIO_LOADING_STATE_UNLOADING) return;
+		evictingDesc = nullptr;
+	}
+
+	FMOD_STUDIO_MEMORY_USAGE usage;
+	if (!checkErrors(system->getMemoryUsage(&usage)) || usage.sampledata <= sampleDataBudget) return;
+
+	// evict the least recently used description that has no instances
+	for (auto e = sampleCache.front(); e; e = e->next()) {
+		DescriptionInfo *descInfo = e->get();
+		int instanceCount = 0;
+		checkErrors(descInfo->desc->getInstanceCount(&instanceCount));
+		if (instanceCount > 0) continue;
+		checkErrors(descInfo->desc->unloadSampleData());
+		sampleCache.erase(e);
+		descInfo->sampleCacheEntry = nullptr;
+		evictingDesc = descInfo->desc;
+		sampleCacheEvictions++;
+		return;
+	}
+	sampleCacheBusy = true;
+}
+
 void Fmod::setListenerLock(uint8_t index, bool isLocked) {
 	if (index < 0 || index + 1 > listeners.size()) {
 		print_error("FMOD Sound System: Invalid listener ID");
@@ -362,22 +753,236 @@ void Fmod::waitForAllLoads() {
 }
 
 String Fmod::loadbank(const String &pathToBank, int flags) {
-	if (banks.has(pathToBank)) return pathToBank; // bank is already loaded
-	FMOD::Studio::Bank *bank = nullptr;
-	checkErrors(system->loadBankFile(pathToBank.ascii().get_data(), flags, &bank));
-	if (bank) {
-		banks.insert(pathToBank, bank);
+	if (banks.has(pathToBank)) { // bank is already loaded
+		bankReferences[pathToBank]++;
 		return pathToBank;
 	}
+	// read through FileAccess so res:// paths, exported .pck files and non-ASCII paths all work
+	// FMOD keeps its own copy of the userdata, so the path only has to live until loadBankCustom returns
+	CharString path = pathToBank.utf8();
+	FMOD_STUDIO_BANK_INFO info;
+	memset(&info, 0, sizeof(info));
+	info.size = sizeof(info);
+	info.userdata = (void *)path.get_data();
+	info.userdatalength = path.length() + 1;
+	info.opencallback = Callbacks::fileOpen;
+	info.closecallback = Callbacks::fileClose;
+	info.readcallback = Callbacks::fileRead;
+	info.seekcallback = Callbacks::fileSeek;
+	FMOD::Studio::Bank *bank = nullptr;
+	checkErrors(system->loadBankCustom(&info, flags, &bank));
+	if (bank) addLoadedBank(pathToBank, bank, flags);
 	return pathToBank;
 }
 
+String Fmod::loadBankMemory(const String &name, const PoolByteArray &data, int flags) {
+	if (banks.has(name)) { // bank is already loaded
+		bankReferences[name]++;
+		return name;
+	}
+	// Godot doesn't align arrays the way FMOD needs for MEMORY_POINT, so copy once into memory that is.
+	// FMOD then reads that copy in place instead of keeping another one of its own.
+	const uintptr_t alignment = FMOD_STUDIO_LOAD_MEMORY_ALIGNMENT;
+	uint8_t *allocation = (uint8_t *)memalloc(data.size() + alignment - 1);
+	uint8_t *buffer = (uint8_t *)(((uintptr_t)allocation + alignment - 1) & ~(alignment - 1));
+	PoolByteArray::Read read = data.read();
+	memcpy(buffer, read.ptr(), data.size());
+
+	FMOD::Studio::Bank *bank = nullptr;
+	checkErrors(system->loadBankMemory((const char *)buffer, data.size(), FMOD_STUDIO_LOAD_MEMORY_POINT, flags, &bank));
+	if (!bank) {
+		memfree(allocation);
+		return name;
+	}
+	bankMemory.insert(name, allocation);
+	addLoadedBank(name, bank, flags);
+	return name;
+}
+
+void Fmod::addLoadedBank(const String &name, FMOD::Studio::Bank *bank, int flags) {
+	banks.insert(name, bank);
+	bankReferences.insert(name, 1);
+	if (flags & FMOD_STUDIO_LOAD_BANK_NONBLOCKING) {
+		// indexed and signalled from update() once the Studio thread is done with it
+		PendingBank pending;
+		pending.path = name;
+		pending.bank = bank;
+		pendingBanks.push_back(pending);
+	} else {
+		indexLoadedBank(bank);
+	}
+}
+
+void Fmod::releaseBankData(const String &name) {
+	if (!bankMemory.has(name)) return;
+	// the unload command has to be processed before the memory FMOD points at can go away
+	checkErrors(system->flushCommands());
+	memfree(bankMemory[name]);
+	bankMemory.erase(name);
+}
+
+String Fmod::loadBankAsync(const String &pathToBank, int flags) {
+	return loadbank(pathToBank, flags | FMOD_STUDIO_LOAD_BANK_NONBLOCKING);
+}
+
+void Fmod::indexLoadedBank(FMOD::Studio::Bank *bank) {
+	// the bank may bring global parameters whose names failed to resolve so far, look them up again
+	for (size_t i = globalParameterTokens.size(); i-- > 0;) {
+		if (globalParameterTokens[i].token == 0) globalParameterTokens.erase(globalParameterTokens.begin() + i);
+	}
+	int stringCount = 0;
+	bank->getStringCount(&stringCount);
+	if (stringCount > 0) {
+		// a strings bank gives paths to events of banks that were loaded before it
+		for (auto e = banks.front(); e; e = e->next())
+			indexBankEvents(e->get());
+	} else {
+		indexBankEvents(bank);
+	}
+}
+
+void Fmod::updatePendingBanks() {
+	// take the finished banks out first, the signal handlers may load or unload banks themselves
+	struct FinishedBank {
+		PendingBank pending;
+		FMOD_STUDIO_LOADING_STATE state;
+		FMOD_RESULT result;
+	};
+	std::vector<FinishedBank> finished;
+	// walk backwards since finished banks are swapped out with the last one
+	for (int i = (int)pendingBanks.size() - 1; i >= 0; i--) {
+		FinishedBank bank;
+		bank.pending = pendingBanks[i];
+		// when loading failed, the reason is returned by getLoadingState itself
+		bank.result = bank.pending.bank->getLoadingState(&bank.state);
+		if (bank.state == FMOD_STUDIO_LOADING_STATE_LOADING) continue;
+
+		pendingBanks[i] = pendingBanks.back();
+		pendingBanks.pop_back();
+		finished.push_back(bank);
+	}
+
+	for (size_t i = 0; i < finished.size(); i++) {
+		const PendingBank &pending = finished[i].pending;
+		// false once an earlier handler unloaded the bank
+		bool isLoaded = banks.has(pending.path) && banks[pending.path] == pending.bank;
+
+		if (finished[i].state == FMOD_STUDIO_LOADING_STATE_LOADED) {
+			if (!isLoaded) continue;
+			indexLoadedBank(pending.bank);
+			emit_signal("bank_loaded", pending.path);
+		} else {
+			String error = FMOD_ErrorString(finished[i].result);
+			print_error("FMOD Sound System: Failed to load bank " + pending.path + ": " + error);
+			if (isLoaded) {
+				pending.bank->unload();
+				banks.erase(pending.path);
+				bankReferences.erase(pending.path);
+				releaseBankData(pending.path);
+				// the references are gone, so no set may unload a bank loaded later under this path
+				for (auto e = bankSets.front(); e; e = e->next()) {
+					std::vector<String> &held = e->get().heldBanks;
+					held.erase(std::remove(held.begin(), held.end(), pending.path), held.end());
+				}
+			}
+			emit_signal("bank_failed", pending.path, error);
+			continue;
+		}
+
+		// events of acquired sets may have just become available
+		for (auto e = bankSets.front(); e; e = e->next()) {
+			if (e->get().references > 0) preloadBankSetSamples(e->get());
+		}
+	}
+}
+
 void Fmod::unloadBank(const String &pathToBank) {
 	if (!banks.has(pathToBank)) return; // bank is not loaded
+	// only unload once nothing else holds the bank
+	if (--bankReferences[pathToBank] > 0) return;
+	bankReferences.erase(pathToBank);
 	auto bank = banks.find(pathToBank);
 	if (bank->value()) {
+		// a bank unloaded before it finished loading is no longer pending
+		for (int i = 0; i < (int)pendingBanks.size(); i++) {
+			if (pendingBanks[i].bank == bank->value()) {
+				pendingBanks[i] = pendingBanks.back();
+				pendingBanks.pop_back();
+				break;
+			}
+		}
+		unindexBankEvents(bank->value());
 		checkErrors(bank->value()->unload());
 		banks.erase(pathToBank);
+		releaseBankData(pathToBank);
+	}
+}
+
+int Fmod::getBankReferenceCount(const String &pathToBank) {
+	if (!bankReferences.has(pathToBank)) return 0; // bank is not loaded
+	return bankReferences[pathToBank];
+}
+
+void Fmod::defineBankSet(const String &setName, const Array &bankPaths, const Array &preloadEvents) {
+	if (bankSets.has(setName) && bankSets[setName].references > 0) {
+		print_error("FMOD Sound System: Cannot redefine bank set " + setName + " while it is acquired");
+		return;
+	}
+	BankSet bankSet;
+	for (int i = 0; i < bankPaths.size(); i++)
+		bankSet.bankPaths.push_back(bankPaths[i]);
+	for (int i = 0; i < preloadEvents.size(); i++)
+		bankSet.preloadEvents.push_back(preloadEvents[i]);
+	bankSet.preloadedDescs.resize(bankSet.preloadEvents.size(), nullptr);
+	bankSets[setName] = bankSet;
+}
+
+bool Fmod::acquireBankSet(const String &setName, int flags) {
+	if (!bankSets.has(setName)) {
+		print_error("FMOD Sound System: Unknown bank set " + setName);
+		return false;
+	}
+	BankSet &bankSet = bankSets[setName];
+	bankSet.references++;
+	if (bankSet.references > 1) return true; // already acquired, banks and samples are loaded
+
+	bool loaded = true;
+	for (size_t i = 0; i < bankSet.bankPaths.size(); i++) {
+		loadbank(bankSet.bankPaths[i], flags);
+		if (banks.has(bankSet.bankPaths[i])) bankSet.heldBanks.push_back(bankSet.bankPaths[i]);
+		else loaded = false;
+	}
+	preloadBankSetSamples(bankSet);
+	return loaded;
+}
+
+void Fmod::releaseBankSet(const String &setName) {
+	if (!bankSets.has(setName) || bankSets[setName].references == 0) return; // set is not acquired
+	BankSet &bankSet = bankSets[setName];
+	if (--bankSet.references > 0) return;
+
+	// sample data loading is reference counted by FMOD, so this only unloads samples no one else asked for
+	for (size_t i = 0; i < bankSet.preloadedDescs.size(); i++) {
+		FMOD::Studio::EventDescription *desc = bankSet.preloadedDescs[i];
+		if (desc && desc->isValid()) checkErrors(desc->unloadSampleData());
+		bankSet.preloadedDescs[i] = nullptr;
+	}
+	for (size_t i = 0; i < bankSet.heldBanks.size(); i++)
+		unloadBank(bankSet.heldBanks[i]);
+	bankSet.heldBanks.clear();
+}
+
+void Fmod::preloadBankSetSamples(BankSet &bankSet) {
+	for (size_t i = 0; i < bankSet.preloadEvents.size(); i++) {
+		if (bankSet.preloadedDescs[i]) continue;
+		// events of banks that are still loading are picked up once the bank is done
+		DescriptionInfo *descInfo = nullptr;
+		if (!eventDescriptions.lookup(bankSet.preloadEvents[i], descInfo)) {
+			if (!pendingBanks.empty()) continue;
+			descInfo = findDescription(bankSet.preloadEvents[i]);
+			if (!descInfo) continue;
+		}
+		if (checkErrors(descInfo->desc->loadSampleData())) bankSet.preloadedDescs[i] = descInfo->desc;
 	}
 }
 
@@ -433,25 +1038,25 @@ int Fmod::getBankVCACount(const String &pathToBank) {
 }
 
 uint64_t Fmod::descCreateInstance(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return 0;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return 0;
 	auto instance = createInstance(desc, false, nullptr);
 	if (instance)
-		return (uint64_t)instance;
+		return getEventInfo(instance)->instanceId;
 	return 0;
 }
 
 int Fmod::descGetLength(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return -1;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return -1;
 	int length = 0;
 	checkErrors(desc->getLength(&length));
 	return length;
 }
 
 String Fmod::descGetPath(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return String("Invalid handle!");
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return String("Invalid handle!");
 	char path[256];
 	int retrived = 0;
 	checkErrors(desc->getPath(path, 256, &retrived));
@@ -460,111 +1065,113 @@ String Fmod::descGetPath(uint64_t descHandle) {
 
 Array Fmod::descGetInstanceList(uint64_t descHandle) {
 	Array array;
-	if (!ptrToEventDescMap.has(descHandle)) return array;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return array;
 	FMOD::Studio::EventInstance *arr[128];
 	int count = 0;
 	checkErrors(desc->getInstanceList(arr, 128, &count));
 	for (int i = 0; i < count; i++) {
-		array.append((uint64_t)arr[i]);
+		// only instances tracked by the integration have a handle
+		EventInfo *eventInfo = getEventInfo(arr[i]);
+		if (eventInfo) array.append(eventInfo->instanceId);
 	}
 	return array;
 }
 
 int Fmod::descGetInstanceCount(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return -1;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return -1;
 	int count = 0;
 	checkErrors(desc->getInstanceCount(&count));
 	return count;
 }
 
 void Fmod::descReleaseAllInstances(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return;
 
 	checkErrors(desc->releaseAllInstances());
 }
 
 void Fmod::descLoadSampleData(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return;
 	checkErrors(desc->loadSampleData());
 }
 
 void Fmod::descUnloadSampleData(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return;
 	checkErrors(desc->unloadSampleData());
 }
 
 int Fmod::descGetSampleLoadingState(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return -1;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return -1;
 	FMOD_STUDIO_LOADING_STATE s;
 	checkErrors(desc->getSampleLoadingState(&s));
 	return s;
 }
 
 bool Fmod::descIs3D(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return false;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return false;
 	bool is3D = false;
 	checkErrors(desc->is3D(&is3D));
 	return is3D;
 }
 
 bool Fmod::descIsOneShot(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return false;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return false;
 	bool isOneShot = false;
 	checkErrors(desc->isOneshot(&isOneShot));
 	return isOneShot;
 }
 
 bool Fmod::descIsSnapshot(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return false;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return false;
 	bool isSnapshot = false;
 	checkErrors(desc->isSnapshot(&isSnapshot));
 	return isSnapshot;
 }
 
 bool Fmod::descIsStream(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return false;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return false;
 	bool isStream = false;
 	checkErrors(desc->isStream(&isStream));
 	return isStream;
 }
 
 bool Fmod::descHasCue(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return false;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return false;
 	bool hasCue = false;
 	checkErrors(desc->hasCue(&hasCue));
 	return hasCue;
 }
 
 float Fmod::descGetMaximumDistance(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return 0.f;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return 0.f;
 	float maxDist = 0.f;
 	checkErrors(desc->getMaximumDistance(&maxDist));
 	return maxDist;
 }
 
 float Fmod::descGetMinimumDistance(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return 0.f;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return 0.f;
 	float minDist = 0.f;
 	checkErrors(desc->getMinimumDistance(&minDist));
 	return minDist;
 }
 
 float Fmod::descGetSoundSize(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return 0.f;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return 0.f;
 	float soundSize = 0.f;
 	checkErrors(desc->getSoundSize(&soundSize));
 	return soundSize;
@@ -572,14 +1179,13 @@ float Fmod::descGetSoundSize(uint64_t descHandle) {
 
 Dictionary Fmod::descGetParameterDescriptionByName(uint64_t descHandle, const String &name) {
 	Dictionary paramDesc;
-	if (!ptrToEventDescMap.has(descHandle)) return paramDesc;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return paramDesc;
 
 	FMOD_STUDIO_PARAMETER_DESCRIPTION pDesc;
 	if (checkErrors(desc->getParameterDescriptionByName(name.ascii().get_data(), &pDesc))) {
 		paramDesc["name"] = String(pDesc.name);
-		paramDesc["id_first"] = pDesc.id.data1;
-		paramDesc["id_second"] = pDesc.id.data2;
+		paramDesc["id"] = packParameterId(pDesc.id);
 		paramDesc["minimum"] = pDesc.minimum;
 		paramDesc["maximum"] = pDesc.maximum;
 		paramDesc["default_value"] = pDesc.defaultvalue;
@@ -588,18 +1194,14 @@ Dictionary Fmod::descGetParameterDescriptionByName(uint64_t descHandle, const St
 	return paramDesc;
 }
 
-Dictionary Fmod::descGetParameterDescriptionByID(uint64_t descHandle, const Array &idPair) {
+Dictionary Fmod::descGetParameterDescriptionByID(uint64_t descHandle, uint64_t parameterId) {
 	Dictionary paramDesc;
-	if (!ptrToEventDescMap.has(descHandle) || idPair.size() != 2) return paramDesc;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
-	FMOD_STUDIO_PARAMETER_ID paramId;
-	paramId.data1 = (unsigned int)idPair[0];
-	paramId.data2 = (unsigned int)idPair[1];
+	auto desc = getDescription(descHandle);
+	if (!desc) return paramDesc;
 	FMOD_STUDIO_PARAMETER_DESCRIPTION pDesc;
-	if (checkErrors(desc->getParameterDescriptionByID(paramId, &pDesc))) {
+	if (checkErrors(desc->getParameterDescriptionByID(unpackParameterId(parameterId), &pDesc))) {
 		paramDesc["name"] = String(pDesc.name);
-		paramDesc["id_first"] = pDesc.id.data1;
-		paramDesc["id_second"] = pDesc.id.data2;
+		paramDesc["id"] = packParameterId(pDesc.id);
 		paramDesc["minimum"] = pDesc.minimum;
 		paramDesc["maximum"] = pDesc.maximum;
 		paramDesc["default_value"] = pDesc.defaultvalue;
@@ -608,8 +1210,8 @@ Dictionary Fmod::descGetParameterDescriptionByID(uint64_t descHandle, const Arra
 }
 
 int Fmod::descGetParameterDescriptionCount(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return 0;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return 0;
 	int count = 0;
 	checkErrors(desc->getParameterDescriptionCount(&count));
 	return count;
@@ -617,13 +1219,12 @@ int Fmod::descGetParameterDescriptionCount(uint64_t descHandle) {
 
 Dictionary Fmod::descGetParameterDescriptionByIndex(uint64_t descHandle, int index) {
 	Dictionary paramDesc;
-	if (!ptrToEventDescMap.has(descHandle)) return paramDesc;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return paramDesc;
 	FMOD_STUDIO_PARAMETER_DESCRIPTION pDesc;
 	if (checkErrors(desc->getParameterDescriptionByIndex(index, &pDesc))) {
 		paramDesc["name"] = String(pDesc.name);
-		paramDesc["id_first"] = pDesc.id.data1;
-		paramDesc["id_second"] = pDesc.id.data2;
+		paramDesc["id"] = packParameterId(pDesc.id);
 		paramDesc["minimum"] = pDesc.minimum;
 		paramDesc["maximum"] = pDesc.maximum;
 		paramDesc["default_value"] = pDesc.defaultvalue;
@@ -633,8 +1234,8 @@ Dictionary Fmod::descGetParameterDescriptionByIndex(uint64_t descHandle, int ind
 
 Dictionary Fmod::descGetUserProperty(uint64_t descHandle, String name) {
 	Dictionary propDesc;
-	if (!ptrToEventDescMap.has(descHandle)) return propDesc;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return propDesc;
 	FMOD_STUDIO_USER_PROPERTY uProp;
 	if (checkErrors(desc->getUserProperty(name.ascii().get_data(), &uProp))) {
 		FMOD_STUDIO_USER_PROPERTY_TYPE fType = uProp.type;
@@ -652,8 +1253,8 @@ Dictionary Fmod::descGetUserProperty(uint64_t descHandle, String name) {
 }
 
 int Fmod::descGetUserPropertyCount(uint64_t descHandle) {
-	if (!ptrToEventDescMap.has(descHandle)) return -1;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return -1;
 	int count = 0;
 	checkErrors(desc->getUserPropertyCount(&count));
 	return count;
@@ -661,8 +1262,8 @@ int Fmod::descGetUserPropertyCount(uint64_t descHandle) {
 
 Dictionary Fmod::descUserPropertyByIndex(uint64_t descHandle, int index) {
 	Dictionary propDesc;
-	if (!ptrToEventDescMap.has(descHandle)) return propDesc;
-	auto desc = ptrToEventDescMap.find(descHandle)->value();
+	auto desc = getDescription(descHandle);
+	if (!desc) return propDesc;
 	FMOD_STUDIO_USER_PROPERTY uProp;
 	if (checkErrors(desc->getUserPropertyByIndex(index, &uProp))) {
 		FMOD_STUDIO_USER_PROPERTY_TYPE fType = uProp.type;
@@ -679,107 +1280,232 @@ Dictionary Fmod::descUserPropertyByIndex(uint64_t descHandle, int index) {
 	return propDesc;
 }
 
-uint64_t Fmod::createEventInstance(const String &eventPath) {
+uint64_t Fmod::createEventInstance(const StringName &eventPath) {
 	FMOD::Studio::EventInstance *instance = createInstance(eventPath, false, nullptr);
 	if (instance) {
-		uint64_t instanceId = (uint64_t)instance;
-		events.insert(instanceId, instance);
-		return instanceId;
+		return getEventInfo(instance)->instanceId;
 	}
 	return 0;
 }
 
-FMOD::Studio::EventInstance *Fmod::createInstance(const String eventPath, const bool isOneShot, Object *gameObject) {
-	if (!eventDescriptions.has(eventPath)) {
-		FMOD::Studio::EventDescription *desc = nullptr;
-		auto res = checkErrors(system->getEvent(eventPath.ascii().get_data(), &desc));
-		if (!res) return 0;
-		eventDescriptions.insert(eventPath, desc);
-	}
-	auto desc = eventDescriptions.find(eventPath);
-	FMOD::Studio::EventInstance *instance;
-	checkErrors(desc->value()->createInstance(&instance));
-	if (instance && (!isOneShot || gameObject)) {
-		auto *eventInfo = new EventInfo();
-		eventInfo->gameObj = gameObject;
-		instance->setUserData(eventInfo);
-		auto instanceId = (uint64_t)instance;
-		events[instanceId] = instance;
-	}
-	return instance;
+FMOD::Studio::EventInstance *Fmod::createInstance(const StringName &eventPath, const bool isOneShot, Object *gameObject) {
+	DescriptionInfo *descInfo = findDescription(eventPath);
+	if (!descInfo) return nullptr;
+	return createInstance(descInfo->desc, isOneShot, gameObject);
 }
 
-FMOD::Studio::EventInstance *Fmod::createInstance(FMOD::Studio::EventDescription *eventDesc, bool isOneShot, Object *gameObject) {
+FMOD::Studio::EventInstance *Fmod::createInstance(FMOD::Studio::EventDescription *eventDesc, bool isOneShot, Object *gameObject, bool tracked) {
 	auto desc = eventDesc;
-	FMOD::Studio::EventInstance *instance;
+	if (sampleDataBudget > 0) touchSampleData(getDescriptionInfo(desc));
+	if (isOneShot) {
+		DescriptionInfo *descInfo = nullptr;
+		desc->getUserData((void **)&descInfo);
+		if (descInfo && descInfo->pool) {
+			EventPool *pool = descInfo->pool;
+			if (!pool->idle.empty() || pool->overflowPolicy != POOL_OVERFLOW_CREATE)
+				return acquirePooledInstance(pool, gameObject);
+		}
+	}
+	FMOD::Studio::EventInstance *instance = nullptr;
 	checkErrors(desc->createInstance(&instance));
-	if (instance && (!isOneShot || gameObject)) {
-		auto *eventInfo = new EventInfo();
-		eventInfo->gameObj = gameObject;
+	if (instance && (!isOneShot || gameObject || tracked)) {
+		EventInfo *eventInfo = eventInfoPool.acquire();
+		eventInfo->instance = instance;
+		eventInfo->isOneShot = isOneShot;
+		eventInfo->instanceId = events.insert(eventInfo);
 		instance->setUserData(eventInfo);
-		auto instanceId = (uint64_t)instance;
-		events[instanceId] = instance;
+		// lifetime notifications let update() reap instances without polling them
+		checkErrors(instance->setCallback(Callbacks::eventCallback, INTERNAL_CALLBACK_MASK));
+		if (gameObject) attachEvent(eventInfo, gameObject);
 	}
 	return instance;
 }
 
-float Fmod::getEventParameterByName(uint64_t instanceId, const String &parameterName) {
+FMOD::Studio::EventInstance *Fmod::acquirePooledInstance(EventPool *pool, Object *gameObject) {
+	EventInfo *eventInfo = nullptr;
+	if (!pool->idle.empty()) {
+		eventInfo = pool->idle.back();
+		pool->idle.pop_back();
+	} else if (pool->overflowPolicy == POOL_OVERFLOW_STEAL_OLDEST && !pool->playing.empty()) {
+		eventInfo = pool->playing.front();
+		pool->playing.erase(pool->playing.begin());
+		checkErrors(eventInfo->instance->stop(FMOD_STUDIO_STOP_IMMEDIATE));
+		detachEvent(eventInfo);
+	} else {
+		return nullptr; // dropped
+	}
+	pool->playing.push_back(eventInfo);
+	eventInfo->attributesSent = false;
+	if (gameObject) attachEvent(eventInfo, gameObject);
+	return eventInfo->instance;
+}
+
+void Fmod::recyclePooledInstance(EventInfo *eventInfo) {
+	// a STOPPED record can be stale: the instance may have been stolen or reacquired since it fired,
+	// and is then starting or playing again. Only an instance that is still stopped goes back.
+	FMOD_STUDIO_PLAYBACK_STATE state;
+	if (!checkErrors(eventInfo->instance->getPlaybackState(&state)) || state != FMOD_STUDIO_PLAYBACK_STOPPED) return;
+	untrackLimitedInstance(eventInfo);
+	EventPool *pool = eventInfo->pool;
+	for (size_t i = 0; i < pool->playing.size(); i++) {
+		if (pool->playing[i] == eventInfo) {
+			pool->playing.erase(pool->playing.begin() + i);
+			detachEvent(eventInfo);
+			pool->idle.push_back(eventInfo);
+			return;
+		}
+	}
+}
+
+void Fmod::removeFromPool(EventInfo *eventInfo) {
+	EventPool *pool = eventInfo->pool;
+	if (!pool) return;
+	pool->idle.erase(std::remove(pool->idle.begin(), pool->idle.end(), eventInfo), pool->idle.end());
+	pool->playing.erase(std::remove(pool->playing.begin(), pool->playing.end(), eventInfo), pool->playing.end());
+	eventInfo->pool = nullptr;
+}
+
+void Fmod::destroyEventPool(DescriptionInfo *descInfo) {
+	EventPool *pool = descInfo->pool;
+	if (!pool) return;
+	for (size_t i = 0; i < pool->idle.size(); i++) {
+		pool->idle[i]->pool = nullptr;
+		releaseOneEvent(pool->idle[i]->instance);
+	}
+	// playing instances finish as regular one-shots
+	for (size_t i = 0; i < pool->playing.size(); i++) {
+		pool->playing[i]->pool = nullptr;
+		pool->playing[i]->isOneShot = true;
+	}
+	descInfo->pool = nullptr;
+	delete pool;
+}
+
+void Fmod::setEventPoolSize(const StringName &eventPath, int size, int overflowPolicy) {
+	if (overflowPolicy < POOL_OVERFLOW_CREATE || overflowPolicy > POOL_OVERFLOW_DROP) {
+		print_error("FMOD Sound System: Invalid pool overflow policy");
+		return;
+	}
+	DescriptionInfo *descInfo = findDescription(eventPath);
+	if (!descInfo) return;
+	destroyEventPool(descInfo);
+	if (size <= 0) return;
+
+	EventPool *pool = new EventPool();
+	pool->overflowPolicy = overflowPolicy;
+	for (int i = 0; i < size; i++) {
+		FMOD::Studio::EventInstance *instance = createInstance(descInfo->desc, false, nullptr);
+		if (!instance) break;
+		EventInfo *eventInfo = getEventInfo(instance);
+		eventInfo->pool = pool;
+		pool->idle.push_back(eventInfo);
+	}
+	descInfo->pool = pool;
+}
+
+int Fmod::getEventPoolSize(const StringName &eventPath) {
+	DescriptionInfo *descInfo = findDescription(eventPath);
+	if (!descInfo || !descInfo->pool) return 0;
+	return descInfo->pool->idle.size() + descInfo->pool->playing.size();
+}
+
+float Fmod::getEventParameterByName(uint64_t instanceId, const StringName &parameterName) {
 	float p = -1;
-	if (!events.has(instanceId)) return p;
-	auto i = events.find(instanceId);
-	if (i->value())
-		checkErrors(i->value()->getParameterByName(parameterName.ascii().get_data(), &p));
+	auto instance = getInstance(instanceId);
+	if (!instance) return p;
+	FMOD_STUDIO_PARAMETER_ID id;
+	if (!getParameterId(getEventParameterToken(instanceId, parameterName), id)) return p;
+	checkErrors(instance->getParameterByID(id, &p));
 	return p;
 }
 
-void Fmod::setEventParameterByName(uint64_t instanceId, const String &parameterName, float value) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	if (i->value()) checkErrors(i->value()->setParameterByName(parameterName.ascii().get_data(), value));
+void Fmod::setEventParameterByName(uint64_t instanceId, const StringName &parameterName, float value) {
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	FMOD_STUDIO_PARAMETER_ID id;
+	if (!getParameterId(getEventParameterToken(instanceId, parameterName), id)) return;
+	checkErrors(instance->setParameterByID(id, value));
 }
 
-float Fmod::getEventParameterByID(uint64_t instanceId, const Array &idPair) {
-	if (!events.has(instanceId) || idPair.size() != 2) return -1.0f;
-	auto i = events.find(instanceId);
-	if (i->value()) {
-		FMOD_STUDIO_PARAMETER_ID id;
-		id.data1 = idPair[0];
-		id.data2 = idPair[1];
-		float value;
-		checkErrors(i->value()->getParameterByID(id, &value));
-		return value;
-	}
-	return -1.0f;
+int Fmod::getEventParameterToken(uint64_t instanceId, const StringName &parameterName) {
+	auto instance = getInstance(instanceId);
+	if (!instance) return 0;
+	DescriptionInfo *descInfo = getInstanceDescription(instance);
+	if (!descInfo) return 0;
+	return resolveParameterToken(descInfo, parameterName);
 }
 
-void Fmod::setEventParameterByID(uint64_t instanceId, const Array &idPair, float value) {
-	if (!events.has(instanceId) || idPair.size() != 2) return;
-	auto i = events.find(instanceId);
-	if (i->value()) {
+float Fmod::getEventParameterByToken(uint64_t instanceId, int token) {
+	float value = -1.0f;
+	auto instance = getInstance(instanceId);
+	FMOD_STUDIO_PARAMETER_ID id;
+	if (!instance || !getParameterId(token, id)) return value;
+	checkErrors(instance->getParameterByID(id, &value));
+	return value;
+}
+
+void Fmod::setEventParameterByToken(uint64_t instanceId, int token, float value) {
+	auto instance = getInstance(instanceId);
+	FMOD_STUDIO_PARAMETER_ID id;
+	if (!instance || !getParameterId(token, id)) return;
+	checkErrors(instance->setParameterByID(id, value));
+}
+
+void Fmod::setEventParametersByTokens(uint64_t instanceId, const PoolIntArray &tokens, const PoolRealArray &values) {
+	auto instance = getInstance(instanceId);
+	if (!instance || !stageParameterBatch(tokens, values)) return;
+	checkErrors(instance->setParametersByIDs(batchIds.data(), batchValues.data(), (int)batchIds.size()));
+}
+
+Fmod::DescriptionInfo *Fmod::getInstanceDescription(FMOD::Studio::EventInstance *instance) {
+	FMOD::Studio::EventDescription *desc = nullptr;
+	if (!checkErrors(instance->getDescription(&desc))) return nullptr;
+	return getDescriptionInfo(desc);
+}
+
+void Fmod::setInstanceParameters(FMOD::Studio::EventInstance *instance, DescriptionInfo *descInfo, const Dictionary &parameters) {
+	// walk the keys in place instead of copying them into an Array, then set everything in one call
+	batchIds.clear();
+	batchValues.clear();
+	for (const Variant *key = parameters.next(); key; key = parameters.next(key)) {
 		FMOD_STUDIO_PARAMETER_ID id;
-		id.data1 = idPair[0];
-		id.data2 = idPair[1];
-		checkErrors(i->value()->setParameterByID(id, value));
+		if (!getParameterId(resolveParameterToken(descInfo, *key), id)) continue;
+		batchIds.push_back(id);
+		batchValues.push_back(parameters[*key]);
 	}
+	if (!batchIds.empty())
+		checkErrors(instance->setParametersByIDs(batchIds.data(), batchValues.data(), (int)batchIds.size()));
+}
+
+float Fmod::getEventParameterByID(uint64_t instanceId, uint64_t parameterId) {
+	auto instance = getInstance(instanceId);
+	if (!instance) return -1.0f;
+	float value;
+	checkErrors(instance->getParameterByID(unpackParameterId(parameterId), &value));
+	return value;
+}
+
+void Fmod::setEventParameterByID(uint64_t instanceId, uint64_t parameterId, float value) {
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	checkErrors(instance->setParameterByID(unpackParameterId(parameterId), value));
 }
 
 void Fmod::releaseEvent(uint64_t instanceId) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	FMOD::Studio::EventInstance *event = i->value();
-	if (event) {
-		releaseOneEvent(event);
-	}
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	releaseOneEvent(instance);
 }
 
 void Fmod::releaseOneEvent(FMOD::Studio::EventInstance *eventInstance) {
-	Callbacks::mut->lock();
 	EventInfo *eventInfo = getEventInfo(eventInstance);
-	eventInstance->setUserData(nullptr);
-	events.erase((uint64_t)eventInstance);
+	// the handle dies now, the record itself is freed once FMOD reports the instance as destroyed
+	removeFromPool(eventInfo);
+	untrackLimitedInstance(eventInfo);
+	detachEvent(eventInfo);
+	sampleCacheBusy = false;
+	events.erase(eventInfo->instanceId);
 	checkErrors(eventInstance->release());
-	delete &eventInfo;
-	Callbacks::mut->unlock();
 }
 
 void Fmod::clearNullListeners() {
@@ -800,132 +1526,136 @@ void Fmod::clearNullListeners() {
 }
 
 void Fmod::clearChannelRefs() {
-	if (channels.size() == 0) return;
-
-	std::vector<uint64_t> refs;
-	for (auto e = channels.front(); e; e = e->next()) {
+	// cost is proportional to the number of channels that ended since the last update
+	Callbacks::ChannelEndRecord record;
+	while (Callbacks::channelEnds.pop(record)) {
+		uint64_t handle = channels.handleOfSlot(record.slot);
+		FMOD::Channel **channel = channels.get(handle);
+		// the handle may have been released and its slot reused since the channel ended
+		if (!channel || *channel != record.channel) continue;
+		channels.erase(handle);
+		emit_signal("channel_finished", handle);
+	}
+
+	if (!Callbacks::channelEndsDropped.exchange(false, std::memory_order_relaxed)) return;
+	// some ends were lost, find the channels they belonged to by checking every channel
+	// walk backwards since erasing moves the last channel into the freed slot
+	for (int i = channels.size() - 1; i >= 0; i--) {
+		// queued on a sound that is still opening
+		if (!channels[i]) continue;
 		// Check if the channel is valid by calling any of its getters
 		bool isPaused = false;
-		FMOD_RESULT res = e->get()->getPaused(&isPaused);
-		if (res != FMOD_OK)
-			refs.push_back(e->key());
+		FMOD_RESULT res = channels[i]->getPaused(&isPaused);
+		if (res != FMOD_OK) {
+			uint64_t handle = channels.handleAt(i);
+			channels.erase(handle);
+			emit_signal("channel_finished", handle);
+		}
 	}
-	for (auto ref : refs)
-		channels.erase(ref);
 }
 
 void Fmod::startEvent(uint64_t instanceId) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	if (i->value()) checkErrors(i->value()->start());
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	checkErrors(instance->start());
 }
 
 void Fmod::stopEvent(uint64_t instanceId, int stopMode) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	if (i->value()) {
-		auto m = static_cast<FMOD_STUDIO_STOP_MODE>(stopMode);
-		checkErrors(i->value()->stop(m));
-	}
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	auto m = static_cast<FMOD_STUDIO_STOP_MODE>(stopMode);
+	checkErrors(instance->stop(m));
 }
 
 void Fmod::triggerEventCue(uint64_t instanceId) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	if (i->value()) checkErrors(i->value()->triggerCue());
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	checkErrors(instance->triggerCue());
 }
 
 int Fmod::getEventPlaybackState(uint64_t instanceId) {
-	if (!events.has(instanceId))
-		return -1;
-	else {
-		auto i = events.find(instanceId);
-		if (i->value()) {
-			FMOD_STUDIO_PLAYBACK_STATE s;
-			checkErrors(i->value()->getPlaybackState(&s));
-			return s;
-		}
-		return -1;
-	}
+	auto instance = getInstance(instanceId);
+	if (!instance) return -1;
+	FMOD_STUDIO_PLAYBACK_STATE s;
+	checkErrors(instance->getPlaybackState(&s));
+	return s;
 }
 
 bool Fmod::getEventPaused(uint64_t instanceId) {
-	if (!events.has(instanceId)) return false;
-	auto i = events.find(instanceId);
+	auto instance = getInstance(instanceId);
+	if (!instance) return false;
 	bool paused = false;
-	if (i->value()) checkErrors(i->value()->getPaused(&paused));
+	checkErrors(instance->getPaused(&paused));
 	return paused;
 }
 
 void Fmod::setEventPaused(uint64_t instanceId, bool paused) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	if (i->value()) checkErrors(i->value()->setPaused(paused));
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	checkErrors(instance->setPaused(paused));
 }
 
 float Fmod::getEventPitch(uint64_t instanceId) {
-	if (!events.has(instanceId)) return 0.0f;
-	auto i = events.find(instanceId);
+	auto instance = getInstance(instanceId);
+	if (!instance) return 0.0f;
 	float pitch = 0.0f;
-	if (i->value()) checkErrors(i->value()->getPitch(&pitch));
+	checkErrors(instance->getPitch(&pitch));
 	return pitch;
 }
 
 void Fmod::setEventPitch(uint64_t instanceId, float pitch) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	if (i->value()) checkErrors(i->value()->setPitch(pitch));
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	checkErrors(instance->setPitch(pitch));
 }
 
 float Fmod::getEventVolume(uint64_t instanceId) {
-	if (!events.has(instanceId)) return 0.0f;
-	auto i = events.find(instanceId);
+	auto instance = getInstance(instanceId);
+	if (!instance) return 0.0f;
 	float volume = 0.0f;
-	FMOD::Studio::EventInstance *event = i->value();
-	checkErrors(event->getVolume(&volume));
+	checkErrors(instance->getVolume(&volume));
 	return volume;
 }
 
 void Fmod::setEventVolume(uint64_t instanceId, float volume) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	FMOD::Studio::EventInstance *event = i->value();
-	checkErrors(event->setVolume(volume));
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	checkErrors(instance->setVolume(volume));
 }
 
 int Fmod::getEventTimelinePosition(uint64_t instanceId) {
-	if (!events.has(instanceId)) return 0;
-	auto i = events.find(instanceId);
+	auto instance = getInstance(instanceId);
+	if (!instance) return 0;
 	int tp = 0;
-	if (i->value()) checkErrors(i->value()->getTimelinePosition(&tp));
+	checkErrors(instance->getTimelinePosition(&tp));
 	return tp;
 }
 
 void Fmod::setEventTimelinePosition(uint64_t instanceId, int position) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	if (i->value()) checkErrors(i->value()->setTimelinePosition(position));
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	checkErrors(instance->setTimelinePosition(position));
 }
 
 float Fmod::getEventReverbLevel(uint64_t instanceId, int index) {
-	if (!events.has(instanceId)) return 0.0f;
-	auto i = events.find(instanceId);
+	auto instance = getInstance(instanceId);
+	if (!instance) return 0.0f;
 	float rvl = 0.0f;
-	if (i->value()) checkErrors(i->value()->getReverbLevel(index, &rvl));
+	checkErrors(instance->getReverbLevel(index, &rvl));
 	return rvl;
 }
 
 void Fmod::setEventReverbLevel(uint64_t instanceId, int index, float level) {
-	if (!events.has(instanceId)) return;
-	auto i = events.find(instanceId);
-	if (i->value()) checkErrors(i->value()->setReverbLevel(index, level));
+	auto instance = getInstance(instanceId);
+	if (!instance) return;
+	checkErrors(instance->setReverbLevel(index, level));
 }
 
 bool Fmod::isEventVirtual(uint64_t instanceId) {
-	if (!events.has(instanceId)) return false;
-	auto i = events.find(instanceId);
+	auto instance = getInstance(instanceId);
+	if (!instance) return false;
 	bool v = false;
-	if (i->value()) checkErrors(i->value()->isVirtual(&v));
+	checkErrors(instance->isVirtual(&v));
 	return v;
 }
 
@@ -996,11 +1726,125 @@ bool Fmod::isNull(Object *o) {
 }
 
 Fmod::EventInfo *Fmod::getEventInfo(FMOD::Studio::EventInstance *eventInstance) {
-	EventInfo *eventInfo;
+	EventInfo *eventInfo = nullptr;
 	eventInstance->getUserData((void **)&eventInfo);
 	return eventInfo;
 }
 
+Fmod::EventInfo *Fmod::getEventInfo(uint64_t instanceId) {
+	EventInfo **eventInfo = events.get(instanceId);
+	return eventInfo ? *eventInfo : nullptr;
+}
+
+FMOD::Studio::EventInstance *Fmod::getInstance(uint64_t instanceId) {
+	EventInfo **eventInfo = events.get(instanceId);
+	return eventInfo ? (*eventInfo)->instance : nullptr;
+}
+
+FMOD::Channel *Fmod::getChannel(uint64_t channelHandle) {
+	FMOD::Channel **channel = channels.get(channelHandle);
+	return channel ? *channel : nullptr;
+}
+
+FMOD::ChannelGroup *Fmod::getChannelGroup(uint64_t groupHandle) {
+	FMOD::ChannelGroup **group = channelGroups.get(groupHandle);
+	return group ? *group : nullptr;
+}
+
+FMOD::DSP *Fmod::getDSP(uint64_t dspHandle) {
+	DSPInfo *dspInfo = dsps.get(dspHandle);
+	return dspInfo ? dspInfo->dsp : nullptr;
+}
+
+FMOD::Studio::EventDescription *Fmod::getDescription(uint64_t descHandle) {
+	DescriptionInfo **descInfo = eventDescs.get(descHandle);
+	return descInfo ? (*descInfo)->desc : nullptr;
+}
+
+uint64_t Fmod::getDescriptionHandle(FMOD::Studio::EventDescription *desc) {
+	return getDescriptionInfo(desc)->descHandle;
+}
+
+Fmod::DescriptionInfo *Fmod::getDescriptionInfo(FMOD::Studio::EventDescription *desc) {
+	// the description keeps a pointer to its record so the same handle is handed out every time
+	DescriptionInfo *descInfo = nullptr;
+	desc->getUserData((void **)&descInfo);
+	if (!descInfo) {
+		descInfo = new DescriptionInfo();
+		descInfo->desc = desc;
+		descInfo->descHandle = eventDescs.insert(descInfo);
+		desc->setUserData(descInfo);
+	}
+	return descInfo;
+}
+
+Fmod::DescriptionInfo *Fmod::findDescription(const StringName &eventPath) {
+	DescriptionInfo *descInfo = nullptr;
+	if (eventDescriptions.lookup(eventPath, descInfo)) return descInfo;
+
+	// slow path for GUID strings and banks that were still loading when they were indexed
+	FMOD::Studio::EventDescription *desc = nullptr;
+	if (!checkErrors(system->getEvent(String(eventPath).ascii().get_data(), &desc))) return nullptr;
+	descInfo = getDescriptionInfo(desc);
+	indexDescription(eventPath, descInfo);
+	return descInfo;
+}
+
+void Fmod::indexDescription(const StringName &key, DescriptionInfo *descInfo) {
+	DescriptionInfo *current = nullptr;
+	if (eventDescriptions.lookup(key, current)) {
+		if (current == descInfo) return;
+		// the key moves over, so the old record must not remove it later
+		std::vector<StringName> &keys = current->indexKeys;
+		keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+	}
+	eventDescriptions.set(key, descInfo);
+	descInfo->indexKeys.push_back(key);
+}
+
+void Fmod::indexBankEvents(FMOD::Studio::Bank *bank) {
+	// banks that are still loading are looked up through the slow path in findDescription
+	FMOD_STUDIO_LOADING_STATE state;
+	if (bank->getLoadingState(&state) != FMOD_OK || state != FMOD_STUDIO_LOADING_STATE_LOADED) return;
+
+	int count = 0;
+	if (!checkErrors(bank->getEventCount(&count)) || count == 0) return;
+	std::vector<FMOD::Studio::EventDescription *> descList(count);
+	checkErrors(bank->getEventList(descList.data(), count, &count));
+	for (int i = 0; i < count; i++) {
+		char path[512];
+		int retrieved = 0;
+		// events only have a path when the strings bank is loaded
+		if (descList[i]->getPath(path, 512, &retrieved) != FMOD_OK) continue;
+		indexDescription(StringName(String::utf8(path)), getDescriptionInfo(descList[i]));
+	}
+}
+
+void Fmod::unindexBankEvents(FMOD::Studio::Bank *bank) {
+	int count = 0;
+	if (!checkErrors(bank->getEventCount(&count)) || count == 0) return;
+	std::vector<FMOD::Studio::EventDescription *> descList(count);
+	checkErrors(bank->getEventList(descList.data(), count, &count));
+	for (int i = 0; i < count; i++) {
+		// the description dies with the bank, so its handle has to go as well
+		DescriptionInfo *descInfo = nullptr;
+		descList[i]->getUserData((void **)&descInfo);
+		if (descInfo) {
+			// remove the keys it was indexed under, getPath fails once the strings bank is gone
+			for (const StringName &key : descInfo->indexKeys)
+				eventDescriptions.remove(key);
+			// the instances go with the bank as well
+			destroyEventPool(descInfo);
+			// the sample data goes with the bank, so there is nothing left to unload
+			if (descInfo->sampleCacheEntry) sampleCache.erase(descInfo->sampleCacheEntry);
+			if (evictingDesc == descInfo->desc) evictingDesc = nullptr;
+			eventDescs.erase(descInfo->descHandle);
+			descList[i]->setUserData(nullptr);
+			delete descInfo;
+		}
+	}
+}
+
 void Fmod::loadBus(const String &busPath) {
 	if (!buses.has(busPath)) {
 		FMOD::Studio::Bus *b = nullptr;
@@ -1025,89 +1869,257 @@ FMOD_VECTOR Fmod::toFmodVector(Vector3 vec) {
 	return fv;
 }
 
-FMOD_3D_ATTRIBUTES Fmod::get3DAttributes(FMOD_VECTOR pos, FMOD_VECTOR up, FMOD_VECTOR forward, FMOD_VECTOR vel) {
-	FMOD_3D_ATTRIBUTES f3d;
-	f3d.forward = forward;
-	f3d.position = pos;
-	f3d.up = up;
-	f3d.velocity = vel;
-	return f3d;
+bool Fmod::admitOneShot(DescriptionInfo *descInfo, Object *gameObj, OneShotLimits &limits) {
+	// don't bother creating instances that couldn't be heard
+	if (distanceCulling && !isNull(gameObj) && !isWithinListenerRange(descInfo, gameObj)) {
+		culledByDistance++;
+		return false;
+	}
+
+	// limits are set by path or GUID string, both are among the keys the description was indexed under
+	for (const StringName &key : descInfo->indexKeys) {
+		if (!limits.eventLimit) limits.eventLimit = eventLimits.getptr(key);
+		StringName category;
+		if (!limits.categoryLimit && eventCategories.lookup(key, category)) {
+			InstanceLimit *categoryLimit = categoryLimits.getptr(category);
+			if (categoryLimit && categoryLimit->maxInstances > 0) limits.categoryLimit = categoryLimit;
+		}
+	}
+	return enforceInstanceLimits(limits);
 }
 
-void Fmod::playOneShot(const String &eventName, Object *gameObj) {
-	FMOD::Studio::EventInstance *instance = createInstance(eventName, true, nullptr);
-	if (instance) {
-		// set 3D attributes once
-		if (!isNull(gameObj)) {
-			updateInstance3DAttributes(instance, gameObj);
+FMOD::Studio::EventInstance *Fmod::createOneShot(DescriptionInfo *descInfo, const OneShotLimits &limits, Object *gameObject) {
+	// limited one-shots need an EventInfo so their STOPPED callback takes them off the limit again
+	bool limited = limits.eventLimit || limits.categoryLimit;
+	FMOD::Studio::EventInstance *instance = createInstance(descInfo->desc, true, gameObject, limited);
+	if (instance && limited) trackLimitedInstance(getEventInfo(instance), limits);
+	return instance;
+}
+
+void Fmod::trackLimitedInstance(EventInfo *eventInfo, const OneShotLimits &limits) {
+	// a pooled instance can be restarted while it is still counted
+	untrackLimitedInstance(eventInfo);
+	eventInfo->eventLimit = limits.eventLimit;
+	eventInfo->categoryLimit = limits.categoryLimit;
+	if (eventInfo->eventLimit) eventInfo->eventLimit->playing.push_back(eventInfo);
+	if (eventInfo->categoryLimit) eventInfo->categoryLimit->playing.push_back(eventInfo);
+}
+
+void Fmod::untrackLimitedInstance(EventInfo *eventInfo) {
+	InstanceLimit *limits[2] = { eventInfo->eventLimit, eventInfo->categoryLimit };
+	for (int i = 0; i < 2; i++) {
+		if (!limits[i]) continue;
+		std::vector<EventInfo *> &playing = limits[i]->playing;
+		playing.erase(std::remove(playing.begin(), playing.end(), eventInfo), playing.end());
+	}
+	eventInfo->eventLimit = nullptr;
+	eventInfo->categoryLimit = nullptr;
+}
+
+bool Fmod::isWithinListenerRange(DescriptionInfo *descInfo, Object *gameObj) {
+	if (descInfo->maxDistance < 0.0f) {
+		bool is3D = false;
+		checkErrors(descInfo->desc->is3D(&is3D));
+		descInfo->maxDistance = 0.0f;
+		if (is3D) checkErrors(descInfo->desc->getMaximumDistance(&descInfo->maxDistance));
+	}
+	if (descInfo->maxDistance <= 0.0f) return true; // 2D events are never culled
+
+	FMOD_3D_ATTRIBUTES attr = getNodeAttributes(gameObj, nullptr);
+	toFmodUnits(attr);
+	FMOD_VECTOR pos = attr.position;
+
+	// ask FMOD for the listener positions so locked and manually placed listeners count too
+	int numListeners = 0;
+	checkErrors(system->getNumListeners(&numListeners));
+	float maxDistanceSquared = descInfo->maxDistance * descInfo->maxDistance;
+	for (int i = 0; i < numListeners; i++) {
+		FMOD_3D_ATTRIBUTES attr;
+		if (system->getListenerAttributes(i, &attr) != FMOD_OK) continue;
+		float dx = attr.position.x - pos.x;
+		float dy = attr.position.y - pos.y;
+		float dz = attr.position.z - pos.z;
+		if (dx * dx + dy * dy + dz * dz <= maxDistanceSquared) return true;
+	}
+	return false;
+}
+
+bool Fmod::enforceInstanceLimits(const OneShotLimits &limits) {
+	bool eventFull = limits.eventLimit && (int)limits.eventLimit->playing.size() >= limits.eventLimit->maxInstances;
+	bool categoryFull = limits.categoryLimit && (int)limits.categoryLimit->playing.size() >= limits.categoryLimit->maxInstances;
+	if (!eventFull && !categoryFull) return true;
+
+	if ((eventFull && limits.eventLimit->stealPolicy == STEAL_NONE) || (categoryFull && limits.categoryLimit->stealPolicy == STEAL_NONE)) {
+		culledByLimit++;
+		return false;
+	}
+
+	// a play steals at most one instance, so when both limits are full the victim has to count against both
+	InstanceLimit *limit = eventFull ? limits.eventLimit : limits.categoryLimit;
+	EventInfo *victim = nullptr;
+	float quietest = 0.0f;
+	for (size_t i = 0; i < limit->playing.size(); i++) {
+		EventInfo *candidate = limit->playing[i];
+		if (eventFull && categoryFull && candidate->categoryLimit != limits.categoryLimit) continue;
+		// the list is in start order
+		if (limit->stealPolicy == STEAL_OLDEST) {
+			victim = candidate;
+			break;
 		}
-		checkErrors(instance->start());
-		checkErrors(instance->release());
+		FMOD::ChannelGroup *group = nullptr;
+		float audibility = 0.0f;
+		if (candidate->instance->getChannelGroup(&group) == FMOD_OK && group) group->getAudibility(&audibility);
+		if (!victim || audibility < quietest) {
+			victim = candidate;
+			quietest = audibility;
+		}
+	}
+	if (!victim) {
+		culledByLimit++;
+		return false;
+	}
+	checkErrors(victim->instance->stop(FMOD_STUDIO_STOP_IMMEDIATE));
+	// it no longer counts, its STOPPED callback releases or recycles it
+	untrackLimitedInstance(victim);
+	instancesStolen++;
+	return true;
+}
+
+void Fmod::setEventInstanceLimit(const StringName &eventPath, int maxInstances, int stealPolicy) {
+	InstanceLimit *limit = eventLimits.getptr(eventPath);
+	if (maxInstances <= 0) {
+		if (!limit) return;
+		// playing one-shots stop pointing at the limit before it goes away
+		while (!limit->playing.empty()) {
+			EventInfo *eventInfo = limit->playing.back();
+			limit->playing.pop_back();
+			eventInfo->eventLimit = nullptr;
+		}
+		eventLimits.erase(eventPath);
+		return;
+	}
+	if (!limit) limit = &eventLimits[eventPath];
+	limit->maxInstances = maxInstances;
+	limit->stealPolicy = stealPolicy;
+}
+
+void Fmod::setEventCategory(const StringName &eventPath, const StringName &category) {
+	if (category == StringName()) {
+		eventCategories.remove(eventPath);
+		return;
 	}
+	eventCategories.set(eventPath, category);
 }
 
-void Fmod::playOneShotWithParams(const String &eventName, Object *gameObj, const Dictionary &parameters) {
-	FMOD::Studio::EventInstance *instance = createInstance(eventName, true, nullptr);
+void Fmod::setCategoryInstanceLimit(const StringName &category, int maxInstances, int stealPolicy) {
+	// the entry stays when the limit is lifted, playing one-shots may still point at it
+	InstanceLimit &limit = categoryLimits[category];
+	limit.maxInstances = maxInstances;
+	limit.stealPolicy = stealPolicy;
+}
+
+void Fmod::setDistanceCulling(bool enabled) {
+	distanceCulling = enabled;
+}
+
+bool Fmod::getDistanceCulling() {
+	return distanceCulling;
+}
+
+void Fmod::playOneShot(const StringName &eventName, Object *gameObj) {
+	DescriptionInfo *descInfo = findDescription(eventName);
+	if (descInfo) startOneShot(descInfo, gameObj, nullptr);
+}
+
+void Fmod::playOneShotWithParams(const StringName &eventName, Object *gameObj, const Dictionary &parameters) {
+	DescriptionInfo *descInfo = findDescription(eventName);
+	if (descInfo) startOneShot(descInfo, gameObj, &parameters);
+}
+
+void Fmod::playOneShotAttached(const StringName &eventName, Object *gameObj) {
+	if (isNull(gameObj)) return;
+	DescriptionInfo *descInfo = findDescription(eventName);
+	if (descInfo) startAttachedOneShot(descInfo, gameObj, nullptr);
+}
+
+void Fmod::playOneShotAttachedWithParams(const StringName &eventName, Object *gameObj, const Dictionary &parameters) {
+	if (isNull(gameObj)) return;
+	DescriptionInfo *descInfo = findDescription(eventName);
+	if (descInfo) startAttachedOneShot(descInfo, gameObj, &parameters);
+}
+
+void Fmod::descPlayOneShot(uint64_t descHandle, Object *gameObj) {
+	// a handle skips the String to StringName conversion GDScript does for every path argument
+	DescriptionInfo **descInfo = eventDescs.get(descHandle);
+	if (descInfo) startOneShot(*descInfo, gameObj, nullptr);
+}
+
+void Fmod::descPlayOneShotAttached(uint64_t descHandle, Object *gameObj) {
+	if (isNull(gameObj)) return;
+	DescriptionInfo **descInfo = eventDescs.get(descHandle);
+	if (descInfo) startAttachedOneShot(*descInfo, gameObj, nullptr);
+}
+
+void Fmod::startOneShot(DescriptionInfo *descInfo, Object *gameObj, const Dictionary *parameters) {
+	OneShotLimits limits;
+	if (!admitOneShot(descInfo, gameObj, limits)) return;
+	FMOD::Studio::EventInstance *instance = createOneShot(descInfo, limits, nullptr);
 	if (instance) {
 		// set 3D attributes once
 		if (!isNull(gameObj)) {
 			updateInstance3DAttributes(instance, gameObj);
 		}
 		// set the initial parameter values
-		auto keys = parameters.keys();
-		for (int i = 0; i < keys.size(); i++) {
-			String k = keys[i];
-			float v = parameters[keys[i]];
-			checkErrors(instance->setParameterByName(k.ascii().get_data(), v));
-		}
+		if (parameters) setInstanceParameters(instance, descInfo, *parameters);
 		checkErrors(instance->start());
-		checkErrors(instance->release());
-	}
-}
-
-void Fmod::playOneShotAttached(const String &eventName, Object *gameObj) {
-	if (!isNull(gameObj)) {
-		FMOD::Studio::EventInstance *instance = createInstance(eventName, true, gameObj);
-		if (instance) {
-			checkErrors(instance->start());
-		}
+		// pooled and limited instances are recycled or released once they stop
+		if (!getEventInfo(instance)) checkErrors(instance->release());
 	}
 }
 
-void Fmod::playOneShotAttachedWithParams(const String &eventName, Object *gameObj, const Dictionary &parameters) {
-	if (!isNull(gameObj)) {
-		FMOD::Studio::EventInstance *instance = createInstance(eventName, true, gameObj);
-		if (instance) {
-			// set the initial parameter values
-			auto keys = parameters.keys();
-			for (int i = 0; i < keys.size(); i++) {
-				String k = keys[i];
-				float v = parameters[keys[i]];
-				checkErrors(instance->setParameterByName(k.ascii().get_data(), v));
-			}
-			checkErrors(instance->start());
-		}
+void Fmod::startAttachedOneShot(DescriptionInfo *descInfo, Object *gameObj, const Dictionary *parameters) {
+	OneShotLimits limits;
+	if (!admitOneShot(descInfo, gameObj, limits)) return;
+	FMOD::Studio::EventInstance *instance = createOneShot(descInfo, limits, gameObj);
+	if (instance) {
+		// set the initial parameter values
+		if (parameters) setInstanceParameters(instance, descInfo, *parameters);
+		checkErrors(instance->start());
 	}
 }
 
 void Fmod::attachInstanceToNode(uint64_t instanceId, Object *gameObj) {
-	if (!events.has(instanceId) || isNull(gameObj)) return;
-	auto i = events.find(instanceId);
-	FMOD::Studio::EventInstance *event = i->value();
-	if (event) {
-		EventInfo *eventInfo = getEventInfo(event);
-		eventInfo->gameObj = gameObj;
-	}
+	EventInfo *eventInfo = getEventInfo(instanceId);
+	if (!eventInfo || isNull(gameObj)) return;
+	attachEvent(eventInfo, gameObj);
 }
 
 void Fmod::detachInstanceFromNode(uint64_t instanceId) {
-	if (!events.has(instanceId)) return;
-	auto instance = events.find(instanceId);
-	FMOD::Studio::EventInstance *event = instance->value();
-	if (event) {
-		EventInfo *eventInfo = getEventInfo(event);
-		eventInfo->gameObj = nullptr;
-	}
+	EventInfo *eventInfo = getEventInfo(instanceId);
+	if (!eventInfo) return;
+	detachEvent(eventInfo);
+}
+
+void Fmod::attachEvent(EventInfo *eventInfo, Object *gameObj) {
+	eventInfo->gameObj = gameObj;
+	// don't derive a velocity from the jump between the old and new node
+	eventInfo->motion = MotionHistory();
+	eventInfo->attributesSent = false;
+	if (eventInfo->attachedIndex >= 0) return;
+	eventInfo->attachedIndex = attachedEvents.size();
+	attachedEvents.push_back(eventInfo);
+}
+
+void Fmod::detachEvent(EventInfo *eventInfo) {
+	eventInfo->gameObj = nullptr;
+	int index = eventInfo->attachedIndex;
+	if (index < 0) return;
+	// swap with the last attached instance to keep the list compact
+	EventInfo *last = attachedEvents.back();
+	attachedEvents[index] = last;
+	last->attachedIndex = index;
+	attachedEvents.pop_back();
+	eventInfo->attachedIndex = -1;
 }
 
 void Fmod::pauseAllEvents() {
@@ -1174,37 +2186,73 @@ void Fmod::setVCAVolume(const String &VCAPath, float volume) {
 	checkErrors(vca->value()->setVolume(volume));
 }
 
-uint64_t Fmod::playSound(uint64_t handle) {
-	if (sounds.has(handle)) {
-		auto s = sounds.find(handle)->value();
-		FMOD::Channel *channel = nullptr;
-		checkErrors(coreSystem->playSound(s, nullptr, true, &channel));
-		if (channel) {
-			checkErrors(channel->setPaused(false));
-			channels.insert((uint64_t)channel, channel);
-			return (uint64_t)channel;
-		}
+uint64_t Fmod::playSound(uint64_t handle, uint64_t groupHandle) {
+	FMOD::Sound **sound = sounds.get(handle);
+	if (!sound) return 0;
+	FMOD::ChannelGroup *group = nullptr;
+	if (!getChannelGroupOrMaster(groupHandle, group)) return 0;
+
+	// the handle is valid right away, the channel starts once the sound has opened
+	uint64_t channelHandle = channels.insert(nullptr);
+	PendingSound *pending = findPendingSound(handle);
+	if (pending) {
+		QueuedPlay play;
+		play.channelHandle = channelHandle;
+		play.groupHandle = groupHandle;
+		pending->queuedPlays.push_back(play);
+		return channelHandle;
 	}
-	return 0;
+
+	FMOD::Channel *channel = startChannel(*sound, group, channelHandle);
+	if (!channel) {
+		channels.erase(channelHandle);
+		return 0;
+	}
+	*channels.get(channelHandle) = channel;
+	return channelHandle;
+}
+
+FMOD::Channel *Fmod::startChannel(FMOD::Sound *sound, FMOD::ChannelGroup *group, uint64_t channelHandle, const QueuedPlay *play) {
+	FMOD::Channel *channel = nullptr;
+	// a null group plays on the master channel group
+	checkErrors(coreSystem->playSound(sound, group, true, &channel));
+	if (!channel) return nullptr;
+	// the channel reports its end itself, its slot leads back to the handle
+	checkErrors(channel->setUserData((void *)(uintptr_t)SlotMap<FMOD::Channel *>::slotOf(channelHandle)));
+	checkErrors(channel->setCallback(Callbacks::channelCallback));
+	// a queued play brings what was set on its handle while the sound was opening
+	if (play) {
+		checkErrors(channel->setVolume(play->volume));
+		checkErrors(channel->setPitch(play->pitch));
+	}
+	checkErrors(channel->setPaused(play && play->paused));
+	return channel;
 }
 
 void Fmod::setSoundPaused(uint64_t channelHandle, bool paused) {
-	if (channels.has(channelHandle)) {
-		auto c = channels.find(channelHandle)->value();
+	auto c = getChannel(channelHandle);
+	if (c) {
 		checkErrors(c->setPaused(paused));
+	} else if (QueuedPlay *play = findQueuedPlay(channelHandle)) {
+		play->paused = paused;
 	}
 }
 
 void Fmod::stopSound(uint64_t channelHandle) {
-	if (channels.has(channelHandle)) {
-		auto c = channels.find(channelHandle)->value();
-		checkErrors(c->stop());
+	FMOD::Channel **channel = channels.get(channelHandle);
+	if (!channel) return;
+	if (*channel) {
+		checkErrors((*channel)->stop());
+	} else {
+		// queued on a sound that is still opening, dropping the handle cancels the play
+		channels.erase(channelHandle);
+		emit_signal("channel_finished", channelHandle);
 	}
 }
 
 bool Fmod::isSoundPlaying(uint64_t channelHandle) {
-	if (channels.has(channelHandle)) {
-		auto c = channels.find(channelHandle)->value();
+	auto c = getChannel(channelHandle);
+	if (c) {
 		bool isPlaying = false;
 		checkErrors(c->isPlaying(&isPlaying));
 		return isPlaying;
@@ -1213,62 +2261,438 @@ bool Fmod::isSoundPlaying(uint64_t channelHandle) {
 }
 
 void Fmod::setSoundVolume(uint64_t channelHandle, float volume) {
-	if (channels.has(channelHandle)) {
-		auto c = channels.find(channelHandle)->value();
+	auto c = getChannel(channelHandle);
+	if (c) {
 		checkErrors(c->setVolume(volume));
+	} else if (QueuedPlay *play = findQueuedPlay(channelHandle)) {
+		play->volume = volume;
 	}
 }
 
 float Fmod::getSoundVolume(uint64_t channelHandle) {
-	if (channels.has(channelHandle)) {
-		auto c = channels.find(channelHandle)->value();
+	auto c = getChannel(channelHandle);
+	if (c) {
 		float volume = 0.f;
 		checkErrors(c->getVolume(&volume));
 		return volume;
 	}
-	return 0.f;
+	QueuedPlay *play = findQueuedPlay(channelHandle);
+	return play ? play->volume : 0.f;
 }
 
 float Fmod::getSoundPitch(uint64_t channelHandle) {
-	if (channels.has(channelHandle)) {
-		auto c = channels.find(channelHandle)->value();
+	auto c = getChannel(channelHandle);
+	if (c) {
 		float pitch = 0.f;
 		checkErrors(c->getPitch(&pitch));
 		return pitch;
 	}
-	return 0.f;
+	QueuedPlay *play = findQueuedPlay(channelHandle);
+	return play ? play->pitch : 0.f;
 }
 
 void Fmod::setSoundPitch(uint64_t channelHandle, float pitch) {
-	if (channels.has(channelHandle)) {
-		auto c = channels.find(channelHandle)->value();
+	auto c = getChannel(channelHandle);
+	if (c) {
 		checkErrors(c->setPitch(pitch));
+	} else if (QueuedPlay *play = findQueuedPlay(channelHandle)) {
+		play->pitch = pitch;
 	}
 }
 
-uint64_t Fmod::createSound(const String &path, int mode) {
+uint64_t Fmod::createSound(const String &path, int mode, int decodeBufferSize) {
+	FMOD::Sound *sound = nullptr;
+	FMOD_CREATESOUNDEXINFO info;
+	memset(&info, 0, sizeof(info));
+	info.cbsize = sizeof(info);
+	// in PCM samples, 0 keeps FMOD's default
+	info.decodebuffersize = decodeBufferSize;
+	checkErrors(coreSystem->createSound(path.utf8().get_data(), mode, &info, &sound));
+	return sound ? addSound(sound, mode) : 0;
+}
+
+uint64_t Fmod::createSoundFromMemory(const PoolByteArray &data, int mode, int decodeBufferSize) {
+	if (data.size() == 0) {
+		print_error("FMOD Sound System: Can't create a sound from an empty array");
+		return 0;
+	}
+	PoolByteArray::Read read = data.read();
 	FMOD::Sound *sound = nullptr;
-	checkErrors(coreSystem->createSound(path.ascii().get_data(), mode, nullptr, &sound));
-	if (sound) {
+	FMOD_CREATESOUNDEXINFO info;
+	memset(&info, 0, sizeof(info));
+	info.cbsize = sizeof(info);
+	info.length = data.size();
+	info.decodebuffersize = decodeBufferSize;
+	// point FMOD at the array's memory instead of having it keep a second copy
+	mode = (mode & ~FMOD_OPENMEMORY) | FMOD_OPENMEMORY_POINT;
+	checkErrors(coreSystem->createSound((const char *)read.ptr(), mode, &info, &sound));
+	if (!sound) return 0;
+
+	uint64_t handle = addSound(sound, mode);
+	PinnedData pinned;
+	pinned.data = data;
+	pinned.read = read;
+	pinnedSoundData.insert(handle, pinned);
+	return handle;
+}
+
+uint64_t Fmod::addSound(FMOD::Sound *sound, int mode) {
+	uint64_t handle = sounds.insert(sound);
+	if (mode & FMOD_NONBLOCKING) {
+		// the sound can't be touched until it is ready, updatePendingSounds finishes the setup
+		PendingSound pending;
+		pending.handle = handle;
+		pendingSounds.push_back(pending);
+	} else {
 		checkErrors(sound->setLoopCount(0));
-		sounds.insert((uint64_t)sound, sound);
+	}
+	return handle;
+}
+
+int Fmod::getSoundOpenState(uint64_t handle) {
+	FMOD::Sound **sound = sounds.get(handle);
+	if (!sound) return -1; // invalid handle
+	FMOD_OPENSTATE state;
+	// a failed open is reported through the state, the returned error is the reason
+	(*sound)->getOpenState(&state, nullptr, nullptr, nullptr);
+	return state;
+}
+
+Fmod::PendingSound *Fmod::findPendingSound(uint64_t handle) {
+	for (PendingSound &pending : pendingSounds) {
+		if (pending.handle == handle) return &pending;
+	}
+	return nullptr;
+}
+
+Fmod::QueuedPlay *Fmod::findQueuedPlay(uint64_t channelHandle) {
+	// only channels that haven't started have no Channel yet
+	FMOD::Channel **channel = channels.get(channelHandle);
+	if (!channel || *channel) return nullptr;
+	for (PendingSound &pending : pendingSounds) {
+		for (QueuedPlay &play : pending.queuedPlays) {
+			if (play.channelHandle == channelHandle) return &play;
+		}
+	}
+	return nullptr;
+}
+
+void Fmod::dropQueuedPlays(const std::vector<QueuedPlay> &plays) {
+	// the channels never started, but scripts waiting for them to finish still hear about it
+	for (const QueuedPlay &play : plays) {
+		if (!channels.get(play.channelHandle)) continue; // stopped before the sound was ready
+		channels.erase(play.channelHandle);
+		emit_signal("channel_finished", play.channelHandle);
+	}
+}
+
+void Fmod::updatePendingSounds() {
+	// take the finished sounds out first, the signal handlers may create or release sounds themselves
+	std::vector<PendingSound> finished;
+	// walk backwards since finished sounds are swapped out with the last one
+	for (int i = (int)pendingSounds.size() - 1; i >= 0; i--) {
+		FMOD::Sound *sound = *sounds.get(pendingSounds[i].handle);
+		FMOD_OPENSTATE state;
+		sound->getOpenState(&state, nullptr, nullptr, nullptr);
+		if (state != FMOD_OPENSTATE_READY && state != FMOD_OPENSTATE_ERROR) continue;
+
+		finished.push_back(pendingSounds[i]);
+		pendingSounds[i] = pendingSounds.back();
+		pendingSounds.pop_back();
 	}
 
-	return (uint64_t)sound;
+	for (size_t i = 0; i < finished.size(); i++) {
+		const PendingSound &pending = finished[i];
+		FMOD::Sound **handleSound = sounds.get(pending.handle);
+		if (!handleSound) {
+			// an earlier handler released the sound, its queued channels go with it
+			dropQueuedPlays(pending.queuedPlays);
+			continue;
+		}
+		FMOD::Sound *sound = *handleSound;
+		FMOD_OPENSTATE state;
+		// a failed open is reported through the state, the returned error is the reason
+		FMOD_RESULT result = sound->getOpenState(&state, nullptr, nullptr, nullptr);
+
+		if (state == FMOD_OPENSTATE_READY) {
+			checkErrors(sound->setLoopCount(0));
+			std::vector<QueuedPlay> failed;
+			for (const QueuedPlay &play : pending.queuedPlays) {
+				FMOD::Channel **channel = channels.get(play.channelHandle);
+				if (!channel) continue; // stopped before the sound was ready
+				// the group may have been released in the meantime, play on master then
+				FMOD::ChannelGroup *group = getChannelGroup(play.groupHandle);
+				*channel = startChannel(sound, group, play.channelHandle, &play);
+				if (!*channel) failed.push_back(play);
+			}
+			// signal only once every channel is set up, a handler may release the sound
+			dropQueuedPlays(failed);
+			emit_signal("sound_ready", pending.handle);
+		} else {
+			String error = FMOD_ErrorString(result);
+			print_error("FMOD Sound System: Failed to open sound: " + error);
+			checkErrors(sound->release());
+			eraseSound(pending.handle);
+			dropQueuedPlays(pending.queuedPlays);
+			emit_signal("sound_failed", pending.handle, error);
+		}
+	}
 }
 
 void Fmod::releaseSound(uint64_t handle) {
-	if (!sounds.has(handle)) {
+	FMOD::Sound **sound = sounds.get(handle);
+	if (!sound) {
 		print_error("FMOD Sound System: Invalid handle");
 		return;
 	}
-	auto sound = sounds.find(handle);
-	if (sound->value()) {
-		checkErrors(sound->value()->release());
-		sounds.erase(handle);
+	std::vector<QueuedPlay> dropped;
+	for (int i = 0; i < (int)pendingSounds.size(); i++) {
+		if (pendingSounds[i].handle != handle) continue;
+		dropped.swap(pendingSounds[i].queuedPlays);
+		pendingSounds[i] = pendingSounds.back();
+		pendingSounds.pop_back();
+		break;
+	}
+	checkErrors((*sound)->release());
+	eraseSound(handle);
+	dropQueuedPlays(dropped);
+}
+
+void Fmod::eraseSound(uint64_t handle) {
+	sounds.erase(handle);
+	// Sound::release doesn't return before FMOD stops reading, so the data can go right away
+	pinnedSoundData.erase(handle);
+}
+
+void Fmod::setSoundChannelGroup(uint64_t channelHandle, uint64_t groupHandle) {
+	auto c = getChannel(channelHandle);
+	FMOD::ChannelGroup *group = nullptr;
+	if (c && getChannelGroupOrMaster(groupHandle, group)) {
+		if (!group) checkErrors(coreSystem->getMasterChannelGroup(&group));
+		checkErrors(c->setChannelGroup(group));
 	}
 }
 
+bool Fmod::getChannelGroupOrMaster(uint64_t groupHandle, FMOD::ChannelGroup *&group) {
+	// 0 stands for the master channel group, passed to FMOD as nullptr
+	group = nullptr;
+	if (groupHandle == 0) return true;
+	group = getChannelGroup(groupHandle);
+	if (group) return true;
+	print_error("FMOD Sound System: Invalid channel group handle");
+	return false;
+}
+
+uint64_t Fmod::createChannelGroup(const String &name) {
+	FMOD::ChannelGroup *group = nullptr;
+	// new groups are routed into the master channel group
+	checkErrors(coreSystem->createChannelGroup(name.utf8().get_data(), &group));
+	return group ? channelGroups.insert(group) : 0;
+}
+
+uint64_t Fmod::getMasterChannelGroup() {
+	if (masterGroupHandle) return masterGroupHandle;
+	FMOD::ChannelGroup *group = nullptr;
+	checkErrors(coreSystem->getMasterChannelGroup(&group));
+	if (group) masterGroupHandle = channelGroups.insert(group);
+	return masterGroupHandle;
+}
+
+void Fmod::releaseChannelGroup(uint64_t groupHandle) {
+	auto group = getChannelGroup(groupHandle);
+	if (!group) {
+		print_error("FMOD Sound System: Invalid handle");
+		return;
+	}
+	if (groupHandle == masterGroupHandle) {
+		print_error("FMOD Sound System: The master channel group can't be released");
+		return;
+	}
+	// the group's effects go with it
+	for (int i = dsps.size() - 1; i >= 0; i--) {
+		if (dsps[i].groupHandle != groupHandle) continue;
+		checkErrors(group->removeDSP(dsps[i].dsp));
+		checkErrors(dsps[i].dsp->release());
+		dsps.erase(dsps.handleAt(i));
+	}
+	// channels and child groups of a released group are routed to the master group by FMOD
+	checkErrors(group->release());
+	channelGroups.erase(groupHandle);
+}
+
+void Fmod::addChannelGroupToGroup(uint64_t parentHandle, uint64_t childHandle) {
+	auto parent = getChannelGroup(parentHandle);
+	auto child = getChannelGroup(childHandle);
+	if (parent && child) {
+		checkErrors(parent->addGroup(child));
+	}
+}
+
+void Fmod::setChannelGroupVolume(uint64_t groupHandle, float volume) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		checkErrors(g->setVolume(volume));
+	}
+}
+
+float Fmod::getChannelGroupVolume(uint64_t groupHandle) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		float volume = 0.f;
+		checkErrors(g->getVolume(&volume));
+		return volume;
+	}
+	return 0.f;
+}
+
+void Fmod::setChannelGroupPitch(uint64_t groupHandle, float pitch) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		checkErrors(g->setPitch(pitch));
+	}
+}
+
+float Fmod::getChannelGroupPitch(uint64_t groupHandle) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		float pitch = 0.f;
+		checkErrors(g->getPitch(&pitch));
+		return pitch;
+	}
+	return 0.f;
+}
+
+void Fmod::setChannelGroupPaused(uint64_t groupHandle, bool paused) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		checkErrors(g->setPaused(paused));
+	}
+}
+
+bool Fmod::getChannelGroupPaused(uint64_t groupHandle) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		bool paused = false;
+		checkErrors(g->getPaused(&paused));
+		return paused;
+	}
+	return false;
+}
+
+void Fmod::setChannelGroupMute(uint64_t groupHandle, bool mute) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		checkErrors(g->setMute(mute));
+	}
+}
+
+bool Fmod::getChannelGroupMute(uint64_t groupHandle) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		bool mute = false;
+		checkErrors(g->getMute(&mute));
+		return mute;
+	}
+	return false;
+}
+
+void Fmod::stopChannelGroup(uint64_t groupHandle) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		// stops every channel in the group and its child groups
+		checkErrors(g->stop());
+	}
+}
+
+int Fmod::getChannelGroupNumChannels(uint64_t groupHandle) {
+	auto g = getChannelGroup(groupHandle);
+	if (g) {
+		int count = 0;
+		checkErrors(g->getNumChannels(&count));
+		return count;
+	}
+	return 0;
+}
+
+uint64_t Fmod::addChannelGroupDSP(uint64_t groupHandle, int dspType, int index) {
+	auto g = getChannelGroup(groupHandle);
+	if (!g) {
+		print_error("FMOD Sound System: Invalid handle");
+		return 0;
+	}
+	FMOD::DSP *dsp = nullptr;
+	checkErrors(coreSystem->createDSPByType(static_cast<FMOD_DSP_TYPE>(dspType), &dsp));
+	if (!dsp) return 0;
+	if (!checkErrors(g->addDSP(index, dsp))) {
+		checkErrors(dsp->release());
+		return 0;
+	}
+	DSPInfo dspInfo;
+	dspInfo.dsp = dsp;
+	dspInfo.groupHandle = groupHandle;
+	return dsps.insert(dspInfo);
+}
+
+void Fmod::releaseDSP(uint64_t dspHandle) {
+	DSPInfo *dspInfo = dsps.get(dspHandle);
+	if (!dspInfo) {
+		print_error("FMOD Sound System: Invalid handle");
+		return;
+	}
+	auto g = getChannelGroup(dspInfo->groupHandle);
+	if (g) checkErrors(g->removeDSP(dspInfo->dsp));
+	checkErrors(dspInfo->dsp->release());
+	dsps.erase(dspHandle);
+}
+
+void Fmod::setDSPBypass(uint64_t dspHandle, bool bypass) {
+	auto d = getDSP(dspHandle);
+	if (d) {
+		checkErrors(d->setBypass(bypass));
+	}
+}
+
+bool Fmod::getDSPBypass(uint64_t dspHandle) {
+	auto d = getDSP(dspHandle);
+	if (d) {
+		bool bypass = false;
+		checkErrors(d->getBypass(&bypass));
+		return bypass;
+	}
+	return false;
+}
+
+void Fmod::setDSPParameterFloat(uint64_t dspHandle, int index, float value) {
+	auto d = getDSP(dspHandle);
+	if (d) {
+		checkErrors(d->setParameterFloat(index, value));
+	}
+}
+
+void Fmod::setDSPParameterInt(uint64_t dspHandle, int index, int value) {
+	auto d = getDSP(dspHandle);
+	if (d) {
+		checkErrors(d->setParameterInt(index, value));
+	}
+}
+
+void Fmod::setDSPParameterBool(uint64_t dspHandle, int index, bool value) {
+	auto d = getDSP(dspHandle);
+	if (d) {
+		checkErrors(d->setParameterBool(index, value));
+	}
+}
+
+int Fmod::getDSPNumParameters(uint64_t dspHandle) {
+	auto d = getDSP(dspHandle);
+	if (d) {
+		int count = 0;
+		checkErrors(d->getNumParameters(&count));
+		return count;
+	}
+	return 0;
+}
+
 void Fmod::setSound3DSettings(float dopplerScale, float distanceFactor, float rollOffScale) {
 	if (distanceFactor > 0 && checkErrors(coreSystem->set3DSettings(dopplerScale, distanceFactor, rollOffScale))) {
 		distanceScale = distanceFactor;
@@ -1332,57 +2756,74 @@ void Fmod::setSystemListener3DAttributes(uint8_t index, Vector3 forward, Vector3
 	checkErrors(system->setListenerAttributes(index, &attr));
 }
 
-uint64_t Fmod::getEvent(const String &path) {
-	if (!eventDescriptions.has(path)) {
-		FMOD::Studio::EventDescription *desc = nullptr;
-		auto res = checkErrors(system->getEvent(path.ascii().get_data(), &desc));
-		if (!res) return 0;
-		eventDescriptions.insert(path, desc);
-	}
-	auto desc = eventDescriptions.find(path)->value();
-	auto ptr = (uint64_t)desc;
-	ptrToEventDescMap.insert(ptr, desc);
-
-	return ptr;
+uint64_t Fmod::getEvent(const StringName &path) {
+	DescriptionInfo *descInfo = findDescription(path);
+	if (!descInfo) return 0;
+	return descInfo->descHandle;
 }
 
 void Fmod::setCallback(uint64_t instanceId, int callbackMask) {
-	if (!events.has(instanceId)) return;
-	FMOD::Studio::EventInstance *event = events.find(instanceId)->value();
-	if (event) {
-		checkErrors(event->setCallback(Callbacks::eventCallback, callbackMask));
-	}
+	EventInfo *eventInfo = getEventInfo(instanceId);
+	if (!eventInfo) return;
+	// lifetime notifications stay on regardless of what GDScript subscribes to
+	checkErrors(eventInfo->instance->setCallback(Callbacks::eventCallback, callbackMask | INTERNAL_CALLBACK_MASK));
 }
 
 uint64_t Fmod::getEventDescription(uint64_t instanceId) {
-	if (!events.has(instanceId)) return 0;
+	auto instance = getInstance(instanceId);
+	if (!instance) return 0;
 
-	auto instance = events.find(instanceId)->value();
 	FMOD::Studio::EventDescription *desc = nullptr;
-	checkErrors(instance->getDescription(&desc));
-	auto ptr = (uint64_t)desc;
-	ptrToEventDescMap.insert(ptr, desc);
-
-	return ptr;
+	if (!checkErrors(instance->getDescription(&desc))) return 0;
+	return getDescriptionHandle(desc);
 }
 
 void Fmod::setEvent3DAttributes(uint64_t instanceId, Vector3 forward, Vector3 position, Vector3 up, Vector3 velocity) {
-	if (!events.has(instanceId)) return;
-	auto instance = events.find(instanceId)->value();
+	EventInfo *eventInfo = getEventInfo(instanceId);
+	if (!eventInfo) return;
+	// make sure the attached node's attributes are sent again on the next update
+	eventInfo->attributesSent = false;
 	FMOD_3D_ATTRIBUTES attr;
 	attr.forward = toFmodVector(forward);
 	attr.position = toFmodVector(position);
 	attr.up = toFmodVector(up);
 	attr.velocity = toFmodVector(velocity);
-	checkErrors(instance->set3DAttributes(&attr));
+	checkErrors(eventInfo->instance->set3DAttributes(&attr));
+}
+
+int Fmod::setEvents3DAttributes(const PoolIntArray &handles, const PoolVector3Array &attributes) {
+	// handles are 64 bit but PoolIntArray holds 32 bit ints, so each handle takes two entries (low, high)
+	int count = handles.size() / 2;
+	if (handles.size() % 2 != 0 || attributes.size() != count * 4) {
+		print_error("FMOD Sound System: Expected two ints per handle and four Vector3s (position, forward, up, velocity) per handle");
+		return 0;
+	}
+
+	PoolIntArray::Read h = handles.read();
+	PoolVector3Array::Read a = attributes.read();
+	int applied = 0;
+	for (int i = 0; i < count; i++) {
+		uint64_t instanceId = (uint64_t)(uint32_t)h[i * 2] | ((uint64_t)(uint32_t)h[i * 2 + 1] << 32);
+		EventInfo **eventInfo = events.get(instanceId);
+		if (!eventInfo) continue;
+		const Vector3 *v = &a[i * 4];
+		FMOD_3D_ATTRIBUTES attr;
+		attr.position = toFmodVector(v[0]);
+		attr.forward = toFmodVector(v[1]);
+		attr.up = toFmodVector(v[2]);
+		attr.velocity = toFmodVector(v[3]);
+		(*eventInfo)->attributesSent = false;
+		if (checkErrors((*eventInfo)->instance->set3DAttributes(&attr))) applied++;
+	}
+	return applied;
 }
 
 Dictionary Fmod::getEvent3DAttributes(uint64_t instanceId) {
-	if (!events.has(instanceId)) {
+	auto instance = getInstance(instanceId);
+	if (!instance) {
 		print_error("Invalid event instance handle");
 		return Dictionary();
 	}
-	auto instance = events.find(instanceId)->value();
 	FMOD_3D_ATTRIBUTES attr;
 	checkErrors(instance->get3DAttributes(&attr));
 	Dictionary _3Dattr;
@@ -1398,99 +2839,239 @@ Dictionary Fmod::getEvent3DAttributes(uint64_t instanceId) {
 }
 
 void Fmod::setEventListenerMask(uint64_t instanceId, int mask) {
-	if (!events.has(instanceId)) {
+	auto instance = getInstance(instanceId);
+	if (!instance) {
 		print_error("Invalid event instance handle");
 		return;
 	}
-	auto instance = events.find(instanceId)->value();
 	checkErrors(instance->setListenerMask(mask));
 }
 
 uint32_t Fmod::getEventListenerMask(uint64_t instanceId) {
-	if (!events.has(instanceId)) {
+	auto instance = getInstance(instanceId);
+	if (!instance) {
 		print_error("Invalid event instance handle");
 		return 0;
 	}
-	auto instance = events.find(instanceId)->value();
 	uint32_t mask = 0;
 	checkErrors(instance->getListenerMask(&mask));
 	return mask;
 }
 
 // runs on the Studio update thread, not the game thread
+// must never block, so it only copies the callback parameters into the queue
 FMOD_RESULT F_CALLBACK Callbacks::eventCallback(FMOD_STUDIO_EVENT_CALLBACK_TYPE type, FMOD_STUDIO_EVENTINSTANCE *event, void *parameters) {
-
-	FMOD::Studio::EventInstance *instance = (FMOD::Studio::EventInstance *)event;
-	auto instanceId = (uint64_t)instance;
-	Fmod::EventInfo *eventInfo;
-	mut->lock();
-	// check if instance is still valid
-	if (!instance) {
-		mut->unlock();
+	if (!event) return FMOD_OK;
+
+	CallbackRecord record;
+	record.type = type;
+	record.instance = (FMOD::Studio::EventInstance *)event;
+	record.instance->getUserData(&record.userData);
+	record.timestamp = OS::get_singleton()->get_ticks_usec();
+
+	if (type == FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_MARKER) {
+		FMOD_STUDIO_TIMELINE_MARKER_PROPERTIES *props = (FMOD_STUDIO_TIMELINE_MARKER_PROPERTIES *)parameters;
+		record.position = props->position;
+		strncpy(record.name, props->name, sizeof(record.name) - 1);
+	} else if (type == FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_BEAT) {
+		FMOD_STUDIO_TIMELINE_BEAT_PROPERTIES *props = (FMOD_STUDIO_TIMELINE_BEAT_PROPERTIES *)parameters;
+		record.position = props->position;
+		record.bar = props->bar;
+		record.beat = props->beat;
+		record.tempo = props->tempo;
+		record.timeSignatureUpper = props->timesignatureupper;
+		record.timeSignatureLower = props->timesignaturelower;
+	} else if (type == FMOD_STUDIO_EVENT_CALLBACK_SOUND_PLAYED || type == FMOD_STUDIO_EVENT_CALLBACK_SOUND_STOPPED) {
+		FMOD::Sound *sound = (FMOD::Sound *)parameters;
+		sound->getName(record.name, sizeof(record.name));
+	} else if (type != FMOD_STUDIO_EVENT_CALLBACK_STOPPED && type != FMOD_STUDIO_EVENT_CALLBACK_DESTROYED) {
 		return FMOD_OK;
 	}
-	instance->getUserData((void **)&eventInfo);
-	if (eventInfo) {
-		Callbacks::CallbackInfo callbackInfo = eventInfo->callbackInfo;
-
-		if (type == FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_MARKER) {
-			FMOD_STUDIO_TIMELINE_MARKER_PROPERTIES *props = (FMOD_STUDIO_TIMELINE_MARKER_PROPERTIES *)parameters;
-			callbackInfo.markerCallbackInfo["event_id"] = instanceId;
-			callbackInfo.markerCallbackInfo["name"] = props->name;
-			callbackInfo.markerCallbackInfo["position"] = props->position;
-			callbackInfo.markerSignalEmitted = false;
-		} else if (type == FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_BEAT) {
-			FMOD_STUDIO_TIMELINE_BEAT_PROPERTIES *props = (FMOD_STUDIO_TIMELINE_BEAT_PROPERTIES *)parameters;
-			callbackInfo.beatCallbackInfo["event_id"] = instanceId;
-			callbackInfo.beatCallbackInfo["beat"] = props->beat;
-			callbackInfo.beatCallbackInfo["bar"] = props->bar;
-			callbackInfo.beatCallbackInfo["tempo"] = props->tempo;
-			callbackInfo.beatCallbackInfo["time_signature_upper"] = props->timesignatureupper;
-			callbackInfo.beatCallbackInfo["time_signature_lower"] = props->timesignaturelower;
-			callbackInfo.beatCallbackInfo["position"] = props->position;
-			callbackInfo.beatSignalEmitted = false;
-		} else if (type == FMOD_STUDIO_EVENT_CALLBACK_SOUND_PLAYED || type == FMOD_STUDIO_EVENT_CALLBACK_SOUND_STOPPED) {
-			FMOD::Sound *sound = (FMOD::Sound *)parameters;
-			char n[256];
-			sound->getName(n, 256);
-			String name(n);
-			String mType = type == FMOD_STUDIO_EVENT_CALLBACK_SOUND_PLAYED ? "played" : "stopped";
-			callbackInfo.soundCallbackInfo["name"] = name;
-			callbackInfo.soundCallbackInfo["type"] = mType;
-			callbackInfo.soundSignalEmitted = false;
+
+	if (!overflow.load(std::memory_order_acquire) && queue.push(record)) return FMOD_OK;
+
+	// rare, so allocating here beats losing a record
+	OverflowRecord *node = new OverflowRecord;
+	node->record = record;
+	node->next = overflow.load(std::memory_order_relaxed);
+	while (!overflow.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+	}
+	overflowedRecords.fetch_add(1, std::memory_order_relaxed);
+	return FMOD_OK;
+}
+
+// fires from System::update, on the game thread or the update thread
+FMOD_RESULT F_CALLBACK Callbacks::channelCallback(FMOD_CHANNELCONTROL *channelcontrol, FMOD_CHANNELCONTROL_TYPE controltype, FMOD_CHANNELCONTROL_CALLBACK_TYPE callbacktype, void *commanddata1, void *commanddata2) {
+	if (controltype != FMOD_CHANNELCONTROL_CHANNEL || callbacktype != FMOD_CHANNELCONTROL_CALLBACK_END) return FMOD_OK;
+	FMOD::Channel *channel = (FMOD::Channel *)channelcontrol;
+	void *userData = nullptr;
+	channel->getUserData(&userData);
+
+	ChannelEndRecord record;
+	record.channel = channel;
+	record.slot = (uint32_t)(uintptr_t)userData;
+	if (!channelEnds.push(record))
+		channelEndsDropped.store(true, std::memory_order_relaxed);
+	return FMOD_OK;
+}
+
+namespace {
+
+	// FileAccess reads go through a read-ahead buffer, FMOD asks for lots of small reads while parsing a bank
+	const unsigned int READ_AHEAD_SIZE = 64 * 1024;
+
+	struct BankFile {
+		FileAccess *file = nullptr;
+		unsigned int length = 0;
+
+		// read position as seen by FMOD
+		unsigned int position = 0;
+
+		// file offset of buffer[0] and the number of valid bytes in it
+		unsigned int bufferStart = 0;
+		unsigned int bufferLength = 0;
+		uint8_t buffer[READ_AHEAD_SIZE];
+	};
+
+} // namespace
+
+// file callbacks run on whichever thread FMOD loads the bank from
+FMOD_RESULT F_CALLBACK Callbacks::fileOpen(const char *name, unsigned int *filesize, void **handle, void *userdata) {
+	if (!userdata) return FMOD_ERR_FILE_NOTFOUND;
+	FileAccess *file = FileAccess::open(String::utf8((const char *)userdata), FileAccess::READ);
+	if (!file) return FMOD_ERR_FILE_NOTFOUND;
+	BankFile *bankFile = new BankFile;
+	bankFile->file = file;
+	bankFile->length = file->get_len();
+	*filesize = bankFile->length;
+	*handle = bankFile;
+	return FMOD_OK;
+}
+
+FMOD_RESULT F_CALLBACK Callbacks::fileClose(void *handle, void *userdata) {
+	BankFile *bankFile = (BankFile *)handle;
+	bankFile->file->close();
+	memdelete(bankFile->file);
+	delete bankFile;
+	return FMOD_OK;
+}
+
+FMOD_RESULT F_CALLBACK Callbacks::fileRead(void *handle, void *buffer, unsigned int sizebytes, unsigned int *bytesread, void *userdata) {
+	BankFile *bankFile = (BankFile *)handle;
+	uint8_t *out = (uint8_t *)buffer;
+	unsigned int read = 0;
+	while (read < sizebytes && bankFile->position < bankFile->length) {
+		unsigned int remaining = sizebytes - read;
+		unsigned int offset = bankFile->position - bankFile->bufferStart;
+		if (bankFile->position >= bankFile->bufferStart && offset < bankFile->bufferLength) {
+			// serve from the read-ahead buffer
+			unsigned int count = MIN(remaining, bankFile->bufferLength - offset);
+			memcpy(out + read, bankFile->buffer + offset, count);
+			read += count;
+			bankFile->position += count;
+		} else if (remaining >= READ_AHEAD_SIZE) {
+			// large reads go straight into FMOD's buffer
+			bankFile->file->seek(bankFile->position);
+			unsigned int count = bankFile->file->get_buffer(out + read, remaining);
+			if (count == 0) break;
+			read += count;
+			bankFile->position += count;
+		} else {
+			// refill the read-ahead buffer at the current position
+			bankFile->file->seek(bankFile->position);
+			bankFile->bufferStart = bankFile->position;
+			bankFile->bufferLength = bankFile->file->get_buffer(bankFile->buffer, READ_AHEAD_SIZE);
+			if (bankFile->bufferLength == 0) break;
 		}
 	}
-	mut->unlock();
+	*bytesread = read;
+	return read < sizebytes ? FMOD_ERR_FILE_EOF : FMOD_OK;
+}
+
+FMOD_RESULT F_CALLBACK Callbacks::fileSeek(void *handle, unsigned int pos, void *userdata) {
+	// the buffer stays valid, the next read decides whether it can be reused
+	((BankFile *)handle)->position = pos;
 	return FMOD_OK;
 }
 
 void Fmod::runCallbacks() {
-	Callbacks::mut->lock();
-	for (auto e = events.front(); e; e = e->next()) {
-		FMOD::Studio::EventInstance *eventInstance = e->get();
-		Callbacks::CallbackInfo cbInfo = getEventInfo(eventInstance)->callbackInfo;
-		// check for Marker callbacks
-		if (!cbInfo.markerSignalEmitted) {
-			emit_signal("timeline_marker", cbInfo.markerCallbackInfo);
-			cbInfo.markerSignalEmitted = true;
+	// cost is proportional to the number of callbacks that fired since the last update
+	Callbacks::CallbackRecord record;
+	while (Callbacks::queue.pop(record))
+		dispatchCallback(record);
+
+	// everything in the overflow list fired after what was in the queue
+	Callbacks::OverflowRecord *newest = Callbacks::overflow.exchange(nullptr, std::memory_order_acquire);
+	if (!newest) return;
+	Callbacks::OverflowRecord *oldest = nullptr;
+	while (newest) {
+		Callbacks::OverflowRecord *next = newest->next;
+		newest->next = oldest;
+		oldest = newest;
+		newest = next;
+	}
+	while (oldest) {
+		Callbacks::OverflowRecord *next = oldest->next;
+		dispatchCallback(oldest->record);
+		delete oldest;
+		oldest = next;
+	}
+
+	uint32_t overflowed = Callbacks::overflowedRecords.exchange(0, std::memory_order_relaxed);
+	std::string s = "FMOD Sound System: Callback queue full, " + std::to_string(overflowed) + " callbacks took the slow path";
+	print_verbose(s.c_str());
+}
+
+void Fmod::dispatchCallback(const Callbacks::CallbackRecord &record) {
+	EventInfo *eventInfo = (EventInfo *)record.userData;
+	if (!eventInfo) return;
+	// false once the handle has been released from GDScript
+	bool isLive = getEventInfo(eventInfo->instanceId) == eventInfo;
+
+	if (record.type == FMOD_STUDIO_EVENT_CALLBACK_DESTROYED) {
+		// always the last callback of an instance, so nothing else refers to the record anymore
+		if (isLive) {
+			detachEvent(eventInfo);
+			events.erase(eventInfo->instanceId);
 		}
+		untrackLimitedInstance(eventInfo);
+		eventInfoPool.release(eventInfo);
+		sampleCacheBusy = false;
+		return;
+	}
+	if (!isLive) return;
 
-		// check for Beat callbacks
-		if (!cbInfo.beatSignalEmitted) {
-			emit_signal("timeline_beat", cbInfo.beatCallbackInfo);
-			cbInfo.beatSignalEmitted = true;
-		}
+	if (record.type == FMOD_STUDIO_EVENT_CALLBACK_STOPPED) {
+		// one-shots are owned by the integration, so they are released as soon as they finish
+		if (eventInfo->pool) recyclePooledInstance(eventInfo);
+		else if (eventInfo->isOneShot) releaseOneEvent(eventInfo->instance);
+		return;
+	}
 
-		// check for Sound callbacks
-		if (!cbInfo.soundSignalEmitted) {
-			if (cbInfo.soundCallbackInfo["type"] == "played")
-				emit_signal("sound_played", cbInfo.soundCallbackInfo);
-			else
-				emit_signal("sound_stopped", cbInfo.soundCallbackInfo);
-			cbInfo.soundSignalEmitted = true;
-		}
+	Dictionary params;
+	params["event_id"] = eventInfo->instanceId;
+	params["timestamp"] = record.timestamp;
+	if (record.type == FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_MARKER) {
+		params["name"] = String(record.name);
+		params["position"] = record.position;
+		emit_signal("timeline_marker", params);
+	} else if (record.type == FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_BEAT) {
+		params["beat"] = record.beat;
+		params["bar"] = record.bar;
+		params["tempo"] = record.tempo;
+		params["time_signature_upper"] = record.timeSignatureUpper;
+		params["time_signature_lower"] = record.timeSignatureLower;
+		params["position"] = record.position;
+		emit_signal("timeline_beat", params);
+	} else if (record.type == FMOD_STUDIO_EVENT_CALLBACK_SOUND_PLAYED) {
+		params["name"] = String(record.name);
+		params["type"] = "played";
+		emit_signal("sound_played", params);
+	} else if (record.type == FMOD_STUDIO_EVENT_CALLBACK_SOUND_STOPPED) {
+		params["name"] = String(record.name);
+		params["type"] = "stopped";
+		emit_signal("sound_stopped", params);
 	}
-	Callbacks::mut->unlock();
 }
 
 void Fmod::_bind_methods() {
@@ -1503,10 +3084,14 @@ void Fmod::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("system_set_software_format", "sample_rate", "speaker_mode", "num_raw_speakers"), &Fmod::setSoftwareFormat);
 	ClassDB::bind_method(D_METHOD("system_set_parameter_by_name", "name", "value"), &Fmod::setGlobalParameterByName);
 	ClassDB::bind_method(D_METHOD("system_get_parameter_by_name", "name"), &Fmod::getGlobalParameterByName);
-	ClassDB::bind_method(D_METHOD("system_set_parameter_by_id", "id_pair", "value"), &Fmod::setGlobalParameterByID);
-	ClassDB::bind_method(D_METHOD("system_get_parameter_by_id", "id_pair"), &Fmod::getGlobalParameterByID);
+	ClassDB::bind_method(D_METHOD("system_set_parameter_by_id", "parameter_id", "value"), &Fmod::setGlobalParameterByID);
+	ClassDB::bind_method(D_METHOD("system_get_parameter_by_id", "parameter_id"), &Fmod::getGlobalParameterByID);
+	ClassDB::bind_method(D_METHOD("system_get_parameter_token", "name"), &Fmod::getGlobalParameterToken);
+	ClassDB::bind_method(D_METHOD("system_set_parameter_by_token", "token", "value"), &Fmod::setGlobalParameterByToken);
+	ClassDB::bind_method(D_METHOD("system_get_parameter_by_token", "token"), &Fmod::getGlobalParameterByToken);
+	ClassDB::bind_method(D_METHOD("system_set_parameters_by_tokens", "tokens", "values"), &Fmod::setGlobalParametersByTokens);
 	ClassDB::bind_method(D_METHOD("system_get_parameter_desc_by_name", "name"), &Fmod::getGlobalParameterDescByName);
-	ClassDB::bind_method(D_METHOD("system_get_parameter_desc_by_id", "id_pair"), &Fmod::getGlobalParameterDescByID);
+	ClassDB::bind_method(D_METHOD("system_get_parameter_desc_by_id", "parameter_id"), &Fmod::getGlobalParameterDescByID);
 	ClassDB::bind_method(D_METHOD("system_get_parameter_desc_count"), &Fmod::getGlobalParameterDescCount);
 	ClassDB::bind_method(D_METHOD("system_get_parameter_desc_list"), &Fmod::getGlobalParameterDescList);
 	ClassDB::bind_method(D_METHOD("system_get_num_listeners"), &Fmod::getSystemNumListeners);
@@ -1540,6 +3125,25 @@ void Fmod::_bind_methods() {
 
 	/* Bank functions */
 	ClassDB::bind_method(D_METHOD("bank_load", "path_to_bank", "flags"), &Fmod::loadbank);
+	ClassDB::bind_method(D_METHOD("bank_load_async", "path_to_bank", "flags"), &Fmod::loadBankAsync);
+	ClassDB::bind_method(D_METHOD("bank_load_from_memory", "name", "data", "flags"), &Fmod::loadBankMemory);
+	ClassDB::bind_method(D_METHOD("bank_get_reference_count", "path_to_bank"), &Fmod::getBankReferenceCount);
+	ClassDB::bind_method(D_METHOD("event_set_pool_size", "event_path", "size", "overflow_policy"), &Fmod::setEventPoolSize);
+	ClassDB::bind_method(D_METHOD("event_get_pool_size", "event_path"), &Fmod::getEventPoolSize);
+	ClassDB::bind_method(D_METHOD("event_set_instance_limit", "event_path", "max_instances", "steal_policy"), &Fmod::setEventInstanceLimit);
+	ClassDB::bind_method(D_METHOD("event_set_category", "event_path", "category"), &Fmod::setEventCategory);
+	ClassDB::bind_method(D_METHOD("category_set_instance_limit", "category", "max_instances", "steal_policy"), &Fmod::setCategoryInstanceLimit);
+	ClassDB::bind_method(D_METHOD("system_start_update_thread", "updates_per_second"), &Fmod::startUpdateThread);
+	ClassDB::bind_method(D_METHOD("system_stop_update_thread"), &Fmod::stopUpdateThread);
+	ClassDB::bind_method(D_METHOD("system_is_update_thread_running"), &Fmod::isUpdateThreadRunning);
+	ClassDB::bind_method(D_METHOD("system_set_distance_culling", "enabled"), &Fmod::setDistanceCulling);
+	ClassDB::bind_method(D_METHOD("system_get_distance_culling"), &Fmod::getDistanceCulling);
+	ClassDB::bind_method(D_METHOD("system_set_sample_data_budget", "bytes"), &Fmod::setSampleDataBudget);
+	ClassDB::bind_method(D_METHOD("system_get_sample_data_budget"), &Fmod::getSampleDataBudget);
+	ClassDB::bind_method(D_METHOD("system_set_stream_buffer_size", "bytes"), &Fmod::setStreamBufferSize);
+	ClassDB::bind_method(D_METHOD("bank_set_define", "set_name", "bank_paths", "preload_events"), &Fmod::defineBankSet);
+	ClassDB::bind_method(D_METHOD("bank_set_acquire", "set_name", "flags"), &Fmod::acquireBankSet);
+	ClassDB::bind_method(D_METHOD("bank_set_release", "set_name"), &Fmod::releaseBankSet);
 	ClassDB::bind_method(D_METHOD("bank_unload", "path_to_bank"), &Fmod::unloadBank);
 	ClassDB::bind_method(D_METHOD("bank_get_loading_state", "path_to_bank"), &Fmod::getBankLoadingState);
 	ClassDB::bind_method(D_METHOD("bank_get_bus_count", "path_to_bank"), &Fmod::getBankBusCount);
@@ -1549,6 +3153,8 @@ void Fmod::_bind_methods() {
 
 	/* EventDescription functions */
 	ClassDB::bind_method(D_METHOD("event_desc_create_instance", "desc_handle"), &Fmod::descCreateInstance);
+	ClassDB::bind_method(D_METHOD("event_desc_play_one_shot", "desc_handle", "node"), &Fmod::descPlayOneShot);
+	ClassDB::bind_method(D_METHOD("event_desc_play_one_shot_attached", "desc_handle", "node"), &Fmod::descPlayOneShotAttached);
 	ClassDB::bind_method(D_METHOD("event_desc_get_length", "desc_handle"), &Fmod::descGetLength);
 	ClassDB::bind_method(D_METHOD("event_desc_get_path", "desc_handle"), &Fmod::descGetPath);
 	ClassDB::bind_method(D_METHOD("event_desc_get_instance_list", "desc_handle"), &Fmod::descGetInstanceList);
@@ -1566,7 +3172,7 @@ void Fmod::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("event_desc_get_minimum_distance", "desc_handle"), &Fmod::descGetMinimumDistance);
 	ClassDB::bind_method(D_METHOD("event_desc_get_sound_size", "desc_handle"), &Fmod::descGetSoundSize);
 	ClassDB::bind_method(D_METHOD("event_desc_get_parameter_desc_by_name", "desc_handle", "parameter_name"), &Fmod::descGetParameterDescriptionByName);
-	ClassDB::bind_method(D_METHOD("event_desc_get_parameter_desc_by_id", "desc_handle", "id_pair"), &Fmod::descGetParameterDescriptionByID);
+	ClassDB::bind_method(D_METHOD("event_desc_get_parameter_desc_by_id", "desc_handle", "parameter_id"), &Fmod::descGetParameterDescriptionByID);
 	ClassDB::bind_method(D_METHOD("event_desc_get_parameter_description_count", "desc_handle"), &Fmod::descGetParameterDescriptionCount);
 	ClassDB::bind_method(D_METHOD("event_desc_get_parameter_desc_by_index", "desc_handle", "index"), &Fmod::descGetParameterDescriptionByIndex);
 	ClassDB::bind_method(D_METHOD("event_desc_get_user_property", "desc_handle", "name"), &Fmod::descGetUserProperty);
@@ -1576,8 +3182,12 @@ void Fmod::_bind_methods() {
 	/* EventInstance functions */
 	ClassDB::bind_method(D_METHOD("event_get_parameter_by_name", "handle", "parameter_name"), &Fmod::getEventParameterByName);
 	ClassDB::bind_method(D_METHOD("event_set_parameter_by_name", "handle", "parameter_name", "value"), &Fmod::setEventParameterByName);
-	ClassDB::bind_method(D_METHOD("event_get_parameter_by_id", "handle", "parameter_id_pair"), &Fmod::getEventParameterByID);
-	ClassDB::bind_method(D_METHOD("event_set_parameter_by_id", "handle", "parameter_id_pair", "value"), &Fmod::setEventParameterByID);
+	ClassDB::bind_method(D_METHOD("event_get_parameter_by_id", "handle", "parameter_id"), &Fmod::getEventParameterByID);
+	ClassDB::bind_method(D_METHOD("event_set_parameter_by_id", "handle", "parameter_id", "value"), &Fmod::setEventParameterByID);
+	ClassDB::bind_method(D_METHOD("event_get_parameter_token", "handle", "parameter_name"), &Fmod::getEventParameterToken);
+	ClassDB::bind_method(D_METHOD("event_get_parameter_by_token", "handle", "token"), &Fmod::getEventParameterByToken);
+	ClassDB::bind_method(D_METHOD("event_set_parameter_by_token", "handle", "token", "value"), &Fmod::setEventParameterByToken);
+	ClassDB::bind_method(D_METHOD("event_set_parameters_by_tokens", "handle", "tokens", "values"), &Fmod::setEventParametersByTokens);
 	ClassDB::bind_method(D_METHOD("event_release", "handle"), &Fmod::releaseEvent);
 	ClassDB::bind_method(D_METHOD("event_start", "handle"), &Fmod::startEvent);
 	ClassDB::bind_method(D_METHOD("event_stop", "handle", "stop_mode"), &Fmod::stopEvent);
@@ -1598,6 +3208,7 @@ void Fmod::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("event_get_description", "handle"), &Fmod::getEventDescription);
 	ClassDB::bind_method(D_METHOD("event_set_3D_attributes", "handle", "forward", "position", "up", "velocity"), &Fmod::setEvent3DAttributes);
 	ClassDB::bind_method(D_METHOD("event_get_3D_attributes", "handle"), &Fmod::getEvent3DAttributes);
+	ClassDB::bind_method(D_METHOD("event_set_3D_attributes_batch", "handles", "attributes"), &Fmod::setEvents3DAttributes);
 	ClassDB::bind_method(D_METHOD("event_set_listener_mask", "handle", "mask"), &Fmod::setEventListenerMask);
 	ClassDB::bind_method(D_METHOD("event_get_listener_mask", "handle"), &Fmod::getEventListenerMask);
 
@@ -1615,22 +3226,56 @@ void Fmod::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("vca_set_volume", "path_to_vca", "volume"), &Fmod::setVCAVolume);
 
 	/* Core (Low Level) Sound functions */
-	ClassDB::bind_method(D_METHOD("sound_create", "path_to_sound", "mode"), &Fmod::createSound);
-	ClassDB::bind_method(D_METHOD("sound_play", "handle"), &Fmod::playSound);
+	ClassDB::bind_method(D_METHOD("sound_create", "path_to_sound", "mode", "decode_buffer_size"), &Fmod::createSound, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("sound_create_from_memory", "data", "mode", "decode_buffer_size"), &Fmod::createSoundFromMemory, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("sound_play", "handle", "channel_group_handle"), &Fmod::playSound, DEFVAL(0));
 	ClassDB::bind_method(D_METHOD("sound_stop", "handle"), &Fmod::stopSound);
 	ClassDB::bind_method(D_METHOD("sound_release", "handle"), &Fmod::releaseSound);
+	ClassDB::bind_method(D_METHOD("sound_get_open_state", "handle"), &Fmod::getSoundOpenState);
 	ClassDB::bind_method(D_METHOD("sound_set_paused", "channel_handle", "paused"), &Fmod::setSoundPaused);
 	ClassDB::bind_method(D_METHOD("sound_is_playing", "channel_handle"), &Fmod::isSoundPlaying);
 	ClassDB::bind_method(D_METHOD("sound_set_volume", "channel_handle", "volume"), &Fmod::setSoundVolume);
 	ClassDB::bind_method(D_METHOD("sound_get_volume", "channel_handle"), &Fmod::getSoundVolume);
 	ClassDB::bind_method(D_METHOD("sound_set_pitch", "channel_handle", "pitch"), &Fmod::setSoundPitch);
 	ClassDB::bind_method(D_METHOD("sound_get_pitch", "channel_handle"), &Fmod::getSoundPitch);
+	ClassDB::bind_method(D_METHOD("sound_set_channel_group", "channel_handle", "channel_group_handle"), &Fmod::setSoundChannelGroup);
+
+	/* Channel group functions */
+	ClassDB::bind_method(D_METHOD("channel_group_create", "name"), &Fmod::createChannelGroup);
+	ClassDB::bind_method(D_METHOD("channel_group_get_master"), &Fmod::getMasterChannelGroup);
+	ClassDB::bind_method(D_METHOD("channel_group_release", "channel_group_handle"), &Fmod::releaseChannelGroup);
+	ClassDB::bind_method(D_METHOD("channel_group_add_group", "parent_handle", "child_handle"), &Fmod::addChannelGroupToGroup);
+	ClassDB::bind_method(D_METHOD("channel_group_set_volume", "channel_group_handle", "volume"), &Fmod::setChannelGroupVolume);
+	ClassDB::bind_method(D_METHOD("channel_group_get_volume", "channel_group_handle"), &Fmod::getChannelGroupVolume);
+	ClassDB::bind_method(D_METHOD("channel_group_set_pitch", "channel_group_handle", "pitch"), &Fmod::setChannelGroupPitch);
+	ClassDB::bind_method(D_METHOD("channel_group_get_pitch", "channel_group_handle"), &Fmod::getChannelGroupPitch);
+	ClassDB::bind_method(D_METHOD("channel_group_set_paused", "channel_group_handle", "paused"), &Fmod::setChannelGroupPaused);
+	ClassDB::bind_method(D_METHOD("channel_group_get_paused", "channel_group_handle"), &Fmod::getChannelGroupPaused);
+	ClassDB::bind_method(D_METHOD("channel_group_set_mute", "channel_group_handle", "mute"), &Fmod::setChannelGroupMute);
+	ClassDB::bind_method(D_METHOD("channel_group_get_mute", "channel_group_handle"), &Fmod::getChannelGroupMute);
+	ClassDB::bind_method(D_METHOD("channel_group_stop", "channel_group_handle"), &Fmod::stopChannelGroup);
+	ClassDB::bind_method(D_METHOD("channel_group_get_num_channels", "channel_group_handle"), &Fmod::getChannelGroupNumChannels);
+	ClassDB::bind_method(D_METHOD("channel_group_add_dsp", "channel_group_handle", "dsp_type", "index"), &Fmod::addChannelGroupDSP, DEFVAL(FMOD_CHANNELCONTROL_DSP_TAIL));
+
+	/* DSP functions */
+	ClassDB::bind_method(D_METHOD("dsp_release", "dsp_handle"), &Fmod::releaseDSP);
+	ClassDB::bind_method(D_METHOD("dsp_set_bypass", "dsp_handle", "bypass"), &Fmod::setDSPBypass);
+	ClassDB::bind_method(D_METHOD("dsp_get_bypass", "dsp_handle"), &Fmod::getDSPBypass);
+	ClassDB::bind_method(D_METHOD("dsp_set_parameter_float", "dsp_handle", "index", "value"), &Fmod::setDSPParameterFloat);
+	ClassDB::bind_method(D_METHOD("dsp_set_parameter_int", "dsp_handle", "index", "value"), &Fmod::setDSPParameterInt);
+	ClassDB::bind_method(D_METHOD("dsp_set_parameter_bool", "dsp_handle", "index", "value"), &Fmod::setDSPParameterBool);
+	ClassDB::bind_method(D_METHOD("dsp_get_num_parameters", "dsp_handle"), &Fmod::getDSPNumParameters);
 
 	/* Event Callback Signals */
 	ADD_SIGNAL(MethodInfo("timeline_beat", PropertyInfo(Variant::DICTIONARY, "params")));
 	ADD_SIGNAL(MethodInfo("timeline_marker", PropertyInfo(Variant::DICTIONARY, "params")));
 	ADD_SIGNAL(MethodInfo("sound_played", PropertyInfo(Variant::DICTIONARY, "params")));
 	ADD_SIGNAL(MethodInfo("sound_stopped", PropertyInfo(Variant::DICTIONARY, "params")));
+	ADD_SIGNAL(MethodInfo("bank_loaded", PropertyInfo(Variant::STRING, "path_to_bank")));
+	ADD_SIGNAL(MethodInfo("bank_failed", PropertyInfo(Variant::STRING, "path_to_bank"), PropertyInfo(Variant::STRING, "error")));
+	ADD_SIGNAL(MethodInfo("sound_ready", PropertyInfo(Variant::INT, "handle")));
+	ADD_SIGNAL(MethodInfo("sound_failed", PropertyInfo(Variant::INT, "handle"), PropertyInfo(Variant::STRING, "error")));
+	ADD_SIGNAL(MethodInfo("channel_finished", PropertyInfo(Variant::INT, "channel_handle")));
 
 	/* FMOD_INITFLAGS */
 	BIND_CONSTANT(FMOD_INIT_NORMAL);
@@ -1654,6 +3299,16 @@ void Fmod::_bind_methods() {
 	BIND_CONSTANT(FMOD_STUDIO_INIT_DEFERRED_CALLBACKS);
 	BIND_CONSTANT(FMOD_STUDIO_INIT_LOAD_FROM_UPDATE);
 
+	/* Event pool overflow policies */
+	BIND_CONSTANT(POOL_OVERFLOW_CREATE);
+	BIND_CONSTANT(POOL_OVERFLOW_STEAL_OLDEST);
+	BIND_CONSTANT(POOL_OVERFLOW_DROP);
+
+	/* Instance steal policies */
+	BIND_CONSTANT(STEAL_NONE);
+	BIND_CONSTANT(STEAL_OLDEST);
+	BIND_CONSTANT(STEAL_QUIETEST);
+
 	/* FMOD_STUDIO_LOAD_BANK_FLAGS */
 	BIND_CONSTANT(FMOD_STUDIO_LOAD_BANK_NORMAL);
 	BIND_CONSTANT(FMOD_STUDIO_LOAD_BANK_NONBLOCKING);
@@ -1725,6 +3380,41 @@ void Fmod::_bind_methods() {
 	BIND_CONSTANT(FMOD_IGNORETAGS);
 	BIND_CONSTANT(FMOD_LOWMEM);
 	BIND_CONSTANT(FMOD_VIRTUAL_PLAYFROMSTART);
+
+	/* FMOD_CHANNELCONTROL_DSP_INDEX */
+	BIND_CONSTANT(FMOD_CHANNELCONTROL_DSP_HEAD);
+	BIND_CONSTANT(FMOD_CHANNELCONTROL_DSP_TAIL);
+
+	/* FMOD_DSP_TYPE */
+	BIND_CONSTANT(FMOD_DSP_TYPE_LOWPASS);
+	BIND_CONSTANT(FMOD_DSP_TYPE_LOWPASS_SIMPLE);
+	BIND_CONSTANT(FMOD_DSP_TYPE_HIGHPASS);
+	BIND_CONSTANT(FMOD_DSP_TYPE_HIGHPASS_SIMPLE);
+	BIND_CONSTANT(FMOD_DSP_TYPE_ECHO);
+	BIND_CONSTANT(FMOD_DSP_TYPE_DELAY);
+	BIND_CONSTANT(FMOD_DSP_TYPE_FLANGE);
+	BIND_CONSTANT(FMOD_DSP_TYPE_CHORUS);
+	BIND_CONSTANT(FMOD_DSP_TYPE_TREMOLO);
+	BIND_CONSTANT(FMOD_DSP_TYPE_DISTORTION);
+	BIND_CONSTANT(FMOD_DSP_TYPE_NORMALIZE);
+	BIND_CONSTANT(FMOD_DSP_TYPE_LIMITER);
+	BIND_CONSTANT(FMOD_DSP_TYPE_COMPRESSOR);
+	BIND_CONSTANT(FMOD_DSP_TYPE_PARAMEQ);
+	BIND_CONSTANT(FMOD_DSP_TYPE_THREE_EQ);
+	BIND_CONSTANT(FMOD_DSP_TYPE_PITCHSHIFT);
+	BIND_CONSTANT(FMOD_DSP_TYPE_SFXREVERB);
+	BIND_CONSTANT(FMOD_DSP_TYPE_FADER);
+	BIND_CONSTANT(FMOD_DSP_TYPE_PAN);
+
+	/* FMOD_OPENSTATE */
+	BIND_CONSTANT(FMOD_OPENSTATE_READY);
+	BIND_CONSTANT(FMOD_OPENSTATE_LOADING);
+	BIND_CONSTANT(FMOD_OPENSTATE_ERROR);
+	BIND_CONSTANT(FMOD_OPENSTATE_CONNECTING);
+	BIND_CONSTANT(FMOD_OPENSTATE_BUFFERING);
+	BIND_CONSTANT(FMOD_OPENSTATE_SEEKING);
+	BIND_CONSTANT(FMOD_OPENSTATE_PLAYING);
+	BIND_CONSTANT(FMOD_OPENSTATE_SETPOSITION);
 }
 
 Fmod *Fmod::getSingleton() {
@@ -1735,12 +3425,29 @@ Fmod::Fmod() {
 	singleton = this;
 	system = nullptr;
 	coreSystem = nullptr;
-	Callbacks::mut = Mutex::create();
 	checkErrors(FMOD::Studio::System::create(&system));
 	checkErrors(system->getCoreSystem(&coreSystem));
+	fileReader.install(coreSystem);
+	commandMutex = Mutex::create();
 }
 
 Fmod::~Fmod() {
-	Callbacks::mut->~Mutex();
+	// the update thread must not outlive the mutex and the object it works on
+	stopUpdateThread();
+	// drop batches that were submitted but never executed
+	FmodCommandBatch *batch = commandBatches.exchange(nullptr);
+	while (batch) {
+		FmodCommandBatch *next = batch->next;
+		delete batch;
+		batch = next;
+	}
+	// and callback records that were never dispatched
+	Callbacks::OverflowRecord *record = Callbacks::overflow.exchange(nullptr);
+	while (record) {
+		Callbacks::OverflowRecord *next = record->next;
+		delete record;
+		record = next;
+	}
+	memdelete(commandMutex);
 	singleton = nullptr;
 }
@@ -29,17 +29,29 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <string>
 #include <vector>
 
 #include "core/array.h"
 #include "core/dictionary.h"
+#include "core/list.h"
 #include "core/map.h"
 #include "core/node_path.h"
+#include "core/oa_hash_map.h"
 #include "core/object.h"
+#include "core/os/file_access.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
 #include "core/reference.h"
+#include "core/string_name.h"
 #include "core/vector.h"
 #include "scene/2d/canvas_item.h"
+#include "scene/2d/physics_body_2d.h"
+#include "scene/3d/physics_body.h"
 #include "scene/3d/spatial.h"
 #include "scene/main/node.h"
 
@@ -47,16 +59,90 @@
 #include "api/core/inc/fmod_errors.h"
 #include "api/studio/inc/fmod_studio.hpp"
 
+#include "async_file_reader.h"
 #include "callbacks.h"
+#include "command_buffer.h"
+#include "object_pool.h"
+#include "slot_map.h"
 
 class Fmod : public Object {
 public:
+	// Position history used to derive a velocity for Doppler when the node doesn't provide one
+	struct MotionHistory {
+		Vector3 lastPosition;
+		Vector3 velocity;
+
+		// 0 until the first position has been sampled
+		uint64_t lastUsec = 0;
+	};
+
+	// What a pooled event does when all of its instances are playing
+	enum PoolOverflowPolicy {
+		POOL_OVERFLOW_CREATE, // play an unpooled one-shot instead
+		POOL_OVERFLOW_STEAL_OLDEST, // restart the instance that has been playing the longest
+		POOL_OVERFLOW_DROP // don't play
+	};
+
+	// What a one-shot does when its event or category is at its instance limit
+	enum InstanceStealPolicy {
+		STEAL_NONE, // don't play the new instance
+		STEAL_OLDEST, // stop the instance that was started first
+		STEAL_QUIETEST // stop the least audible instance
+	};
+
+	struct EventPool;
+	struct InstanceLimit;
+
 	struct EventInfo {
+		FMOD::Studio::EventInstance *instance = nullptr;
+
+		// Handle given out to GDScript for this instance
+		uint64_t instanceId = 0;
+
 		// GameObject to which this event is attached
 		Object *gameObj = nullptr;
 
-		// Callback info associated with this event
-		Callbacks::CallbackInfo callbackInfo = Callbacks::CallbackInfo();
+		// Position in attachedEvents, -1 when not attached
+		int attachedIndex = -1;
+
+		// Tracks the attached GameObject between updates
+		MotionHistory motion;
+
+		// Last attributes sent to FMOD for the attached GameObject, unchanged ones are not resent
+		FMOD_3D_ATTRIBUTES sentAttributes;
+		bool attributesSent = false;
+
+		// Index of this instance's command in submittedCommands, only meaningful while the update thread runs
+		int submittedCommand = -1;
+
+		// One-shots are released by the integration once they stop
+		bool isOneShot = false;
+
+		// Pool this instance is recycled to once it stops, nullptr if it isn't pooled
+		EventPool *pool = nullptr;
+
+		// Instance limits this one-shot counts against until it stops, nullptr if there are none
+		InstanceLimit *eventLimit = nullptr;
+		InstanceLimit *categoryLimit = nullptr;
+	};
+
+	// Pre-created instances of one event, reused by the one-shot helpers
+	struct EventPool {
+		std::vector<EventInfo *> idle;
+
+		// oldest first
+		std::vector<EventInfo *> playing;
+
+		int overflowPolicy = POOL_OVERFLOW_CREATE;
+	};
+
+	// Limit on how many instances of an event, or of a category of events, the one-shot helpers keep playing
+	struct InstanceLimit {
+		int maxInstances = 0;
+		int stealPolicy = STEAL_NONE;
+
+		// one-shots counted against the limit, in the order they were started
+		std::vector<EventInfo *> playing;
 	};
 
 private:
@@ -75,32 +161,295 @@ private:
 		// When true, locks the listener in place, disabling internal 3D attribute updates.
 		// 3D attributes can still be manually set with a set3DAttributes call.
 		bool listenerLock = false;
+
+		// Tracks the GameObject between updates
+		MotionHistory motion;
+
+		// Index of this listener's command in submittedCommands, only meaningful while the update thread runs
+		int submittedCommand = -1;
 	};
 	std::vector<Listener> listeners;
 
 	Map<String, FMOD::Studio::Bank *> banks;
-	Map<String, FMOD::Studio::EventDescription *> eventDescriptions;
-	Map<uint64_t, FMOD::Studio::EventDescription *> ptrToEventDescMap;
+
+	// Number of bank_load calls and bank set acquisitions holding each bank, it is unloaded when this reaches 0
+	Map<String, int> bankReferences;
+
+	// Named groups of banks that scenes acquire and release as a whole
+	struct BankSet {
+		std::vector<String> bankPaths;
+		std::vector<StringName> preloadEvents;
+
+		// Descriptions whose sample data was requested for preloadEvents, nullptr until the event is available
+		std::vector<FMOD::Studio::EventDescription *> preloadedDescs;
+
+		// Banks of bankPaths the set holds a reference on, banks that failed to load are left out
+		std::vector<String> heldBanks;
+
+		int references = 0;
+	};
+	Map<String, BankSet> bankSets;
+
+	// Banks loaded with FMOD_STUDIO_LOAD_BANK_NONBLOCKING, polled every update until they finish
+	struct PendingBank {
+		String path;
+		FMOD::Studio::Bank *bank = nullptr;
+	};
+	std::vector<PendingBank> pendingBanks;
+
+	// Array that FMOD reads in place, kept locked until FMOD is done with it
+	struct PinnedData {
+		PoolByteArray data;
+		PoolByteArray::Read read;
+	};
+
+	// Copies of bank data made by bank_load_from_memory, aligned for FMOD_STUDIO_LOAD_MEMORY_POINT.
+	// Holds the pointer returned by memalloc, freed once the bank is unloaded.
+	Map<String, uint8_t *> bankMemory;
 	Map<String, FMOD::Studio::Bus *> buses;
 	Map<String, FMOD::Studio::VCA *> VCAs;
-	Map<uint64_t, FMOD::Studio::EventInstance *> events;
+
+	struct ParameterToken {
+		StringName name;
+		int token = 0;
+	};
+
+	struct DescriptionInfo {
+		FMOD::Studio::EventDescription *desc = nullptr;
+
+		// Handle given out to GDScript for this description
+		uint64_t descHandle = 0;
+
+		// Position in sampleCache while the cache holds this description's sample data
+		List<DescriptionInfo *>::Element *sampleCacheEntry = nullptr;
+
+		// Set when the one-shot helpers should reuse instances of this event
+		EventPool *pool = nullptr;
+
+		// Queried on first use, 0 for 2D events
+		float maxDistance = -1.0f;
+
+		// Parameter names of this event resolved so far
+		std::vector<ParameterToken> parameterTokens;
+
+		// Keys of eventDescriptions that point at this record, paths as well as GUID strings
+		std::vector<StringName> indexKeys;
+	};
+
+	// Parameter IDs resolved from names, a token is an index into this plus one so 0 stays invalid.
+	// Entries live as long as the integration, an ID seen before gets its old token back so reloading banks doesn't grow this.
+	std::vector<FMOD_STUDIO_PARAMETER_ID> parameterIds;
+	OAHashMap<uint64_t, int> parameterTokensById;
+	std::vector<ParameterToken> globalParameterTokens;
+
+	// Reused by the batched parameter setters so they don't allocate per call
+	std::vector<FMOD_STUDIO_PARAMETER_ID> batchIds;
+	std::vector<float> batchValues;
+
+	// Descriptions whose sample data was loaded by the cache, least recently used first.
+	// Only used when a sample data budget is set.
+	List<DescriptionInfo *> sampleCache;
+	int sampleDataBudget = 0;
+
+	// Description evicted last, no further eviction happens until its sample data is unloaded
+	FMOD::Studio::EventDescription *evictingDesc = nullptr;
+
+	// Set when every cached description still had instances, the cache isn't scanned again until
+	// instances are created or released
+	bool sampleCacheBusy = false;
+
+	uint64_t sampleCacheHits = 0;
+	uint64_t sampleCacheMisses = 0;
+	uint64_t sampleCacheEvictions = 0;
+
+	// Instance limits of events and categories, Map nodes don't move so EventInfo can point at them
+	struct OneShotLimits {
+		InstanceLimit *eventLimit = nullptr;
+		InstanceLimit *categoryLimit = nullptr;
+	};
+	Map<StringName, InstanceLimit> eventLimits;
+	OAHashMap<StringName, StringName> eventCategories;
+	Map<StringName, InstanceLimit> categoryLimits;
+
+	// When enabled, one-shots beyond their event's maximum distance from every listener aren't created
+	bool distanceCulling = false;
+
+	uint64_t culledByDistance = 0;
+	uint64_t culledByLimit = 0;
+	uint64_t instancesStolen = 0;
+
+	// Event path -> description, filled in when a bank finishes loading.
+	// StringNames hash and compare by pointer so lookups never touch the path characters.
+	OAHashMap<StringName, DescriptionInfo *> eventDescriptions;
+
+	// Handles given out to GDScript are generational slot map keys, not raw pointers
+	SlotMap<DescriptionInfo *> eventDescs;
+	SlotMap<EventInfo *> events;
+
+	// Storage for the EventInfo records, recycled once FMOD destroys their instance
+	ObjectPool<EventInfo> eventInfoPool;
+
+	// Only the instances attached to a node, walked every update
+	std::vector<EventInfo *> attachedEvents;
+
+	// Callbacks every tracked instance subscribes to so it can be reaped without polling
+	static const FMOD_STUDIO_EVENT_CALLBACK_TYPE INTERNAL_CALLBACK_MASK = FMOD_STUDIO_EVENT_CALLBACK_STOPPED | FMOD_STUDIO_EVENT_CALLBACK_DESTROYED;
 
 	// For playing sounds using FMOD Core / Low Level
-	Map<uint64_t, FMOD::Sound *> sounds;
-	Map<uint64_t, FMOD::Channel *> channels;
+	SlotMap<FMOD::Sound *> sounds;
+	SlotMap<FMOD::Channel *> channels;
+
+	// Channel groups created from GDScript, plus the master group once it has been asked for
+	SlotMap<FMOD::ChannelGroup *> channelGroups;
+	uint64_t masterGroupHandle = 0;
+
+	// Built-in effects added to channel groups
+	struct DSPInfo {
+		FMOD::DSP *dsp = nullptr;
+
+		// Group the DSP was added to
+		uint64_t groupHandle = 0;
+	};
+	SlotMap<DSPInfo> dsps;
+
+	// A sound_play call on a sound that wasn't ready yet
+	struct QueuedPlay {
+		// Slot holds nullptr until the channel starts
+		uint64_t channelHandle = 0;
+		uint64_t groupHandle = 0;
+
+		// Set through the sound_* functions before the channel started, applied once it does
+		float volume = 1.0f;
+		float pitch = 1.0f;
+		bool paused = false;
+	};
+
+	// Sounds created with FMOD_NONBLOCKING, polled every update until they are ready
+	struct PendingSound {
+		uint64_t handle = 0;
+		std::vector<QueuedPlay> queuedPlays;
+	};
+	std::vector<PendingSound> pendingSounds;
+
+	// Sound data opened with FMOD_OPENMEMORY_POINT, pinned until the sound is released
+	Map<uint64_t, PinnedData> pinnedSoundData;
+
+	// Optional thread that runs system->update() at a fixed rate instead of following the game loop.
+	// update() still gathers node transforms on the game thread and hands them over as commands.
+	struct UpdateCommand {
+		enum Type {
+			SET_EVENT_ATTRIBUTES,
+			SET_LISTENER_ATTRIBUTES
+		};
+		Type type = SET_EVENT_ATTRIBUTES;
+		FMOD::Studio::EventInstance *instance = nullptr;
+		// only read on the game thread, when the command is submitted
+		EventInfo *eventInfo = nullptr;
+		int listenerIndex = 0;
+		FMOD_3D_ATTRIBUTES attributes;
+	};
+	Thread *updateThread = nullptr;
+	Mutex *commandMutex = nullptr;
+	std::atomic<bool> updateThreadRunning{ false };
+	int updateThreadRate = 60;
+	int coreInitFlags = 0;
+
+	// Written by the game thread during update()
+	std::vector<UpdateCommand> pendingCommands;
+	// Handed to the update thread under commandMutex, it swaps them with applyingCommands.
+	// Holds at most one command per instance or listener, a newer one replaces the one not applied yet.
+	std::vector<UpdateCommand> submittedCommands;
+	// Only touched by the update thread
+	std::vector<UpdateCommand> applyingCommands;
+
+	// Batches submitted by FmodCommandBuffers on any thread, newest first
+	std::atomic<FmodCommandBatch *> commandBatches{ nullptr };
+	std::vector<FmodCommandBatch *> executingBatches;
+
+	// Serves Core file reads (sounds and streams) through FileAccess on its own thread
+	AsyncFileReader fileReader;
+
+	void executeCommandBatches();
+	void executeCommand(const FmodCommand &command);
+	void playOneShotAt(const StringName &eventPath, const FMOD_3D_ATTRIBUTES &attributes);
+
+	static void updateThreadLoop(void *userdata);
+	void submitCommands();
+	void applyCommands();
 
-	FMOD_3D_ATTRIBUTES get3DAttributes(FMOD_VECTOR pos, FMOD_VECTOR up, FMOD_VECTOR forward, FMOD_VECTOR vel);
 	FMOD_VECTOR toFmodVector(Vector3 vec);
+
+	// Parameter IDs cross into GDScript as one 64 bit int, data1 in the low 32 bits and data2 in the high 32 bits
+	static inline uint64_t packParameterId(const FMOD_STUDIO_PARAMETER_ID &id) {
+		return ((uint64_t)id.data2 << 32) | (uint64_t)id.data1;
+	}
+	static inline FMOD_STUDIO_PARAMETER_ID unpackParameterId(uint64_t packed) {
+		FMOD_STUDIO_PARAMETER_ID id;
+		id.data1 = (unsigned int)(packed & 0xFFFFFFFF);
+		id.data2 = (unsigned int)(packed >> 32);
+		return id;
+	}
 	void setListenerAttributes();
+	void updateAttachedInstances();
 	void updateInstance3DAttributes(FMOD::Studio::EventInstance *i, Object *o);
+	FMOD_3D_ATTRIBUTES getNodeAttributes(Object *o, MotionHistory *motion);
+	void toFmodUnits(FMOD_3D_ATTRIBUTES &attr);
+	Vector3 getNodeVelocity(Object *o, const Vector3 &position, MotionHistory *motion);
 	bool isNull(Object *o);
 	void loadBus(const String &busPath);
 	void loadVCA(const String &VCAPath);
 	void runCallbacks();
-	FMOD::Studio::EventInstance *createInstance(String eventPath, bool isOneShot, Object *gameObject);
-	FMOD::Studio::EventInstance *createInstance(FMOD::Studio::EventDescription *eventDesc, bool isOneShot, Object *gameObject);
+	void dispatchCallback(const Callbacks::CallbackRecord &record);
+	FMOD::Studio::EventInstance *createInstance(const StringName &eventPath, bool isOneShot, Object *gameObject);
+	FMOD::Studio::EventInstance *createInstance(FMOD::Studio::EventDescription *eventDesc, bool isOneShot, Object *gameObject, bool tracked = false);
 	EventInfo *getEventInfo(FMOD::Studio::EventInstance *eventInstance);
+	EventInfo *getEventInfo(uint64_t instanceId);
+	FMOD::Studio::EventInstance *getInstance(uint64_t instanceId);
+	FMOD::Channel *getChannel(uint64_t channelHandle);
+	FMOD::ChannelGroup *getChannelGroup(uint64_t groupHandle);
+	FMOD::DSP *getDSP(uint64_t dspHandle);
+	FMOD::Studio::EventDescription *getDescription(uint64_t descHandle);
+	uint64_t getDescriptionHandle(FMOD::Studio::EventDescription *desc);
+	DescriptionInfo *getDescriptionInfo(FMOD::Studio::EventDescription *desc);
+	DescriptionInfo *findDescription(const StringName &eventPath);
+	void indexBankEvents(FMOD::Studio::Bank *bank);
+	void indexLoadedBank(FMOD::Studio::Bank *bank);
+	void addLoadedBank(const String &name, FMOD::Studio::Bank *bank, int flags);
+	void releaseBankData(const String &name);
+	void preloadBankSetSamples(BankSet &bankSet);
+	void touchSampleData(DescriptionInfo *descInfo);
+	void evictSampleData();
+	FMOD::Studio::EventInstance *acquirePooledInstance(EventPool *pool, Object *gameObject);
+	void recyclePooledInstance(EventInfo *eventInfo);
+	void removeFromPool(EventInfo *eventInfo);
+	void destroyEventPool(DescriptionInfo *descInfo);
+	bool admitOneShot(DescriptionInfo *descInfo, Object *gameObj, OneShotLimits &limits);
+	void startOneShot(DescriptionInfo *descInfo, Object *gameObj, const Dictionary *parameters);
+	void startAttachedOneShot(DescriptionInfo *descInfo, Object *gameObj, const Dictionary *parameters);
+	FMOD::Studio::EventInstance *createOneShot(DescriptionInfo *descInfo, const OneShotLimits &limits, Object *gameObject);
+	void trackLimitedInstance(EventInfo *eventInfo, const OneShotLimits &limits);
+	void untrackLimitedInstance(EventInfo *eventInfo);
+	bool isWithinListenerRange(DescriptionInfo *descInfo, Object *gameObj);
+	bool enforceInstanceLimits(const OneShotLimits &limits);
+	int resolveParameterToken(DescriptionInfo *descInfo, const StringName &parameterName);
+	bool getParameterId(int token, FMOD_STUDIO_PARAMETER_ID &id);
+	bool stageParameterBatch(const PoolIntArray &tokens, const PoolRealArray &values);
+	DescriptionInfo *getInstanceDescription(FMOD::Studio::EventInstance *instance);
+	void setInstanceParameters(FMOD::Studio::EventInstance *instance, DescriptionInfo *descInfo, const Dictionary &parameters);
+	void updatePendingBanks();
+	void updatePendingSounds();
+	PendingSound *findPendingSound(uint64_t handle);
+	QueuedPlay *findQueuedPlay(uint64_t channelHandle);
+	void dropQueuedPlays(const std::vector<QueuedPlay> &plays);
+	FMOD::Channel *startChannel(FMOD::Sound *sound, FMOD::ChannelGroup *group, uint64_t channelHandle, const QueuedPlay *play = nullptr);
+	bool getChannelGroupOrMaster(uint64_t groupHandle, FMOD::ChannelGroup *&group);
+	uint64_t addSound(FMOD::Sound *sound, int mode);
+	void eraseSound(uint64_t handle);
+	void unindexBankEvents(FMOD::Studio::Bank *bank);
+	void indexDescription(const StringName &key, DescriptionInfo *descInfo);
 	void releaseOneEvent(FMOD::Studio::EventInstance *eventInstance);
+	void attachEvent(EventInfo *eventInfo, Object *gameObj);
+	void detachEvent(EventInfo *eventInfo);
 	void clearNullListeners();
 	void clearChannelRefs();
 
@@ -131,13 +480,17 @@ public:
 	void setSystemListenerWeight(uint8_t index, float weight);
 	Dictionary getSystemListener3DAttributes(uint8_t index);
 	void setSystemListener3DAttributes(uint8_t index, Vector3 forward, Vector3 position, Vector3 up, Vector3 velocity);
-	uint64_t getEvent(const String &path);
-	void setGlobalParameterByName(const String &parameterName, float value);
-	float getGlobalParameterByName(const String &parameterName);
-	void setGlobalParameterByID(const Array &idPair, float value);
-	float getGlobalParameterByID(const Array &idPair);
+	uint64_t getEvent(const StringName &path);
+	void setGlobalParameterByName(const StringName &parameterName, float value);
+	float getGlobalParameterByName(const StringName &parameterName);
+	int getGlobalParameterToken(const StringName &parameterName);
+	void setGlobalParameterByToken(int token, float value);
+	float getGlobalParameterByToken(int token);
+	void setGlobalParametersByTokens(const PoolIntArray &tokens, const PoolRealArray &values);
+	void setGlobalParameterByID(uint64_t parameterId, float value);
+	float getGlobalParameterByID(uint64_t parameterId);
 	Dictionary getGlobalParameterDescByName(const String &parameterName);
-	Dictionary getGlobalParameterDescByID(const Array &idPair);
+	Dictionary getGlobalParameterDescByID(uint64_t parameterId);
 	uint32_t getGlobalParameterDescCount();
 	Array getGlobalParameterDescList();
 	Array getAvailableDrivers();
@@ -148,11 +501,13 @@ public:
 	bool getListenerLock(uint8_t index);
 
 	/* Helper functions */
-	uint64_t createEventInstance(const String &eventPath);
-	void playOneShot(const String &eventName, Object *gameObj);
-	void playOneShotWithParams(const String &eventName, Object *gameObj, const Dictionary &parameters);
-	void playOneShotAttached(const String &eventName, Object *gameObj);
-	void playOneShotAttachedWithParams(const String &eventName, Object *gameObj, const Dictionary &parameters);
+	uint64_t createEventInstance(const StringName &eventPath);
+	void playOneShot(const StringName &eventName, Object *gameObj);
+	void playOneShotWithParams(const StringName &eventName, Object *gameObj, const Dictionary &parameters);
+	void playOneShotAttached(const StringName &eventName, Object *gameObj);
+	void playOneShotAttachedWithParams(const StringName &eventName, Object *gameObj, const Dictionary &parameters);
+	void descPlayOneShot(uint64_t descHandle, Object *gameObj);
+	void descPlayOneShotAttached(uint64_t descHandle, Object *gameObj);
 	void attachInstanceToNode(uint64_t instanceId, Object *gameObj);
 	void detachInstanceFromNode(uint64_t instanceId);
 	void pauseAllEvents();
@@ -164,6 +519,25 @@ public:
 
 	/* Bank functions */
 	String loadbank(const String &pathToBank, int flags);
+	String loadBankAsync(const String &pathToBank, int flags);
+	String loadBankMemory(const String &name, const PoolByteArray &data, int flags);
+	int getBankReferenceCount(const String &pathToBank);
+	void setEventPoolSize(const StringName &eventPath, int size, int overflowPolicy);
+	int getEventPoolSize(const StringName &eventPath);
+	void setEventInstanceLimit(const StringName &eventPath, int maxInstances, int stealPolicy);
+	void setEventCategory(const StringName &eventPath, const StringName &category);
+	void setCategoryInstanceLimit(const StringName &category, int maxInstances, int stealPolicy);
+	void startUpdateThread(int updatesPerSecond);
+	void stopUpdateThread();
+	bool isUpdateThreadRunning();
+	void setDistanceCulling(bool enabled);
+	bool getDistanceCulling();
+	void setSampleDataBudget(int bytes);
+	int getSampleDataBudget();
+	void setStreamBufferSize(int bytes);
+	void defineBankSet(const String &setName, const Array &bankPaths, const Array &preloadEvents);
+	bool acquireBankSet(const String &setName, int flags);
+	void releaseBankSet(const String &setName);
 	void unloadBank(const String &pathToBank);
 	int getBankLoadingState(const String &pathToBank);
 	int getBankBusCount(const String &pathToBank);
@@ -190,7 +564,7 @@ public:
 	float descGetMinimumDistance(uint64_t descHandle);
 	float descGetSoundSize(uint64_t descHandle);
 	Dictionary descGetParameterDescriptionByName(uint64_t descHandle, const String &name);
-	Dictionary descGetParameterDescriptionByID(uint64_t descHandle, const Array &idPair);
+	Dictionary descGetParameterDescriptionByID(uint64_t descHandle, uint64_t parameterId);
 	int descGetParameterDescriptionCount(uint64_t descHandle);
 	Dictionary descGetParameterDescriptionByIndex(uint64_t descHandle, int index);
 	Dictionary descGetUserProperty(uint64_t descHandle, String name);
@@ -198,10 +572,14 @@ public:
 	Dictionary descUserPropertyByIndex(uint64_t descHandle, int index);
 
 	/* EventInstance functions */
-	float getEventParameterByName(uint64_t instanceId, const String &parameterName);
-	void setEventParameterByName(uint64_t instanceId, const String &parameterName, float value);
-	float getEventParameterByID(uint64_t instanceId, const Array &idPair);
-	void setEventParameterByID(uint64_t instanceId, const Array &idPair, float value);
+	float getEventParameterByName(uint64_t instanceId, const StringName &parameterName);
+	void setEventParameterByName(uint64_t instanceId, const StringName &parameterName, float value);
+	int getEventParameterToken(uint64_t instanceId, const StringName &parameterName);
+	float getEventParameterByToken(uint64_t instanceId, int token);
+	void setEventParameterByToken(uint64_t instanceId, int token, float value);
+	void setEventParametersByTokens(uint64_t instanceId, const PoolIntArray &tokens, const PoolRealArray &values);
+	float getEventParameterByID(uint64_t instanceId, uint64_t parameterId);
+	void setEventParameterByID(uint64_t instanceId, uint64_t parameterId, float value);
 	void releaseEvent(uint64_t instanceId);
 	void startEvent(uint64_t instanceId);
 	void stopEvent(uint64_t instanceId, int stopMode);
@@ -221,6 +599,7 @@ public:
 	void setCallback(uint64_t instanceId, int callbackMask);
 	uint64_t getEventDescription(uint64_t instanceId);
 	void setEvent3DAttributes(uint64_t instanceId, Vector3 forward, Vector3 position, Vector3 up, Vector3 velocity);
+	int setEvents3DAttributes(const PoolIntArray &handles, const PoolVector3Array &attributes);
 	Dictionary getEvent3DAttributes(uint64_t instanceId);
 	void setEventListenerMask(uint64_t instanceId, int mask);
 	uint32_t getEventListenerMask(uint64_t instanceId);
@@ -239,9 +618,11 @@ public:
 	void setVCAVolume(const String &VCAPath, float volume);
 
 	/* Core (Low Level) Sound functions */
-	uint64_t createSound(const String &path, int mode);
-	uint64_t playSound(uint64_t handle);
+	uint64_t createSound(const String &path, int mode, int decodeBufferSize);
+	uint64_t createSoundFromMemory(const PoolByteArray &data, int mode, int decodeBufferSize);
+	uint64_t playSound(uint64_t handle, uint64_t groupHandle);
 	void releaseSound(uint64_t handle);
+	int getSoundOpenState(uint64_t handle);
 	/* --- */
 	void setSoundPaused(uint64_t channelHandle, bool paused);
 	void stopSound(uint64_t channelHandle);
@@ -250,9 +631,39 @@ public:
 	float getSoundVolume(uint64_t channelHandle);
 	float getSoundPitch(uint64_t channelHandle);
 	void setSoundPitch(uint64_t channelHandle, float pitch);
+	void setSoundChannelGroup(uint64_t channelHandle, uint64_t groupHandle);
+
+	/* Core (Low Level) Channel Group functions */
+	uint64_t createChannelGroup(const String &name);
+	uint64_t getMasterChannelGroup();
+	void releaseChannelGroup(uint64_t groupHandle);
+	void addChannelGroupToGroup(uint64_t parentHandle, uint64_t childHandle);
+	void setChannelGroupVolume(uint64_t groupHandle, float volume);
+	float getChannelGroupVolume(uint64_t groupHandle);
+	void setChannelGroupPitch(uint64_t groupHandle, float pitch);
+	float getChannelGroupPitch(uint64_t groupHandle);
+	void setChannelGroupPaused(uint64_t groupHandle, bool paused);
+	bool getChannelGroupPaused(uint64_t groupHandle);
+	void setChannelGroupMute(uint64_t groupHandle, bool mute);
+	bool getChannelGroupMute(uint64_t groupHandle);
+	void stopChannelGroup(uint64_t groupHandle);
+	int getChannelGroupNumChannels(uint64_t groupHandle);
+	uint64_t addChannelGroupDSP(uint64_t groupHandle, int dspType, int index);
+
+	/* Core (Low Level) DSP functions */
+	void releaseDSP(uint64_t dspHandle);
+	void setDSPBypass(uint64_t dspHandle, bool bypass);
+	bool getDSPBypass(uint64_t dspHandle);
+	void setDSPParameterFloat(uint64_t dspHandle, int index, float value);
+	void setDSPParameterInt(uint64_t dspHandle, int index, int value);
+	void setDSPParameterBool(uint64_t dspHandle, int index, bool value);
+	int getDSPNumParameters(uint64_t dspHandle);
 
 	static Fmod *getSingleton();
 
+	// Safe to call from any thread
+	void submitCommandBatch(FmodCommandBatch *batch);
+
 	Fmod();
 	~Fmod();
 };
@@ -0,0 +1,78 @@
+/*************************************************************************/
+/*  object_pool.h                                                        */
+/*************************************************************************/
+/*                                                                       */
+/*       FMOD Studio module and bindings for the Godot game engine       */
+/*                                                                       */
+/*************************************************************************/
+/* Copyright (c) 2020 Alex Fonseka                                       */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+// Fixed-size block pool for records that are created and destroyed often.
+// Records are allocated BLOCK_SIZE at a time and recycled through a free list, blocks are only freed with the pool,
+// so once the pool has grown to the peak number of live records acquire and release never touch the heap.
+template <class T, int BLOCK_SIZE = 64>
+class ObjectPool {
+	std::vector<T *> blocks;
+	std::vector<T *> freeList;
+
+	void grow() {
+		T *block = new T[BLOCK_SIZE];
+		blocks.push_back(block);
+		// the free list has to be able to hold every record without reallocating on release
+		freeList.reserve(blocks.size() * BLOCK_SIZE);
+		for (int i = BLOCK_SIZE - 1; i >= 0; i--)
+			freeList.push_back(&block[i]);
+	}
+
+public:
+	ObjectPool() = default;
+	ObjectPool(const ObjectPool &) = delete;
+	ObjectPool &operator=(const ObjectPool &) = delete;
+
+	~ObjectPool() {
+		for (T *block : blocks)
+			delete[] block;
+	}
+
+	// returns a record reset to its default state
+	T *acquire() {
+		if (freeList.empty()) grow();
+		T *record = freeList.back();
+		freeList.pop_back();
+		*record = T();
+		return record;
+	}
+
+	void release(T *record) {
+		freeList.push_back(record);
+	}
+
+	void reserve(int count) {
+		while ((int)(blocks.size() * BLOCK_SIZE) < count)
+			grow();
+	}
+};
@@ -8,6 +8,7 @@ static Fmod *fmodPtr = nullptr;
 
 void register_fmod_types() {
 	ClassDB::register_class<Fmod>();
+	ClassDB::register_class<FmodCommandBuffer>();
 	fmodPtr = memnew(Fmod);
 	Engine::get_singleton()->add_singleton(Engine::Singleton("Fmod", Fmod::getSingleton()));
 }
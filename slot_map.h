@@ -0,0 +1,150 @@
+/*************************************************************************/
+/*  slot_map.h                                                           */
+/*************************************************************************/
+/*                                                                       */
+/*       FMOD Studio module and bindings for the Godot game engine       */
+/*                                                                       */
+/*************************************************************************/
+/* Copyright (c) 2020 Alex Fonseka                                       */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Generational slot map used for every handle handed out to GDScript.
+// A handle packs the slot index in the low 32 bits and the slot generation in the high 32 bits.
+// Generations start at 1, so a valid handle is never 0 and 0 can keep meaning "no handle".
+// Values are stored densely (swap-remove on erase) so iterating over them is a linear walk.
+template <class T>
+class SlotMap {
+	static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	struct Slot {
+		uint32_t generation = 1;
+		// index into the dense arrays while the slot is alive, next free slot otherwise
+		uint32_t link = INVALID_INDEX;
+		bool alive = false;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<T> values;
+	std::vector<uint32_t> denseToSlot;
+	uint32_t freeHead = INVALID_INDEX;
+
+	static inline uint32_t indexOf(uint64_t handle) { return (uint32_t)(handle & 0xFFFFFFFF); }
+	static inline uint32_t generationOf(uint64_t handle) { return (uint32_t)(handle >> 32); }
+	static inline uint64_t makeHandle(uint32_t index, uint32_t generation) {
+		return ((uint64_t)generation << 32) | (uint64_t)index;
+	}
+
+	inline const Slot *findSlot(uint64_t handle) const {
+		uint32_t index = indexOf(handle);
+		if (index >= slots.size()) return nullptr;
+		const Slot &slot = slots[index];
+		if (!slot.alive || slot.generation != generationOf(handle)) return nullptr;
+		return &slot;
+	}
+
+public:
+	uint64_t insert(const T &value) {
+		uint32_t index;
+		if (freeHead != INVALID_INDEX) {
+			index = freeHead;
+			freeHead = slots[index].link;
+		} else {
+			index = (uint32_t)slots.size();
+			slots.push_back(Slot());
+		}
+		Slot &slot = slots[index];
+		slot.alive = true;
+		slot.link = (uint32_t)values.size();
+		values.push_back(value);
+		denseToSlot.push_back(index);
+		return makeHandle(index, slot.generation);
+	}
+
+	bool erase(uint64_t handle) {
+		if (!findSlot(handle)) return false;
+		uint32_t index = indexOf(handle);
+		Slot &slot = slots[index];
+
+		// move the last value into the hole to keep the values dense
+		uint32_t dense = slot.link;
+		uint32_t last = (uint32_t)values.size() - 1;
+		if (dense != last) {
+			values[dense] = values[last];
+			denseToSlot[dense] = denseToSlot[last];
+			slots[denseToSlot[dense]].link = dense;
+		}
+		values.pop_back();
+		denseToSlot.pop_back();
+
+		// bump the generation so stale handles to this slot are rejected
+		slot.alive = false;
+		slot.generation++;
+		if (slot.generation == 0) slot.generation = 1;
+		slot.link = freeHead;
+		freeHead = index;
+		return true;
+	}
+
+	inline bool has(uint64_t handle) const {
+		return findSlot(handle) != nullptr;
+	}
+
+	// returns nullptr if the handle is stale or was never handed out
+	inline T *get(uint64_t handle) {
+		const Slot *slot = findSlot(handle);
+		return slot ? &values[slot->link] : nullptr;
+	}
+
+	void reserve(int capacity) {
+		slots.reserve(capacity);
+		values.reserve(capacity);
+		denseToSlot.reserve(capacity);
+	}
+
+	void clear() {
+		while (size() > 0)
+			erase(handleAt(size() - 1));
+	}
+
+	/* Dense access, valid for 0 <= i < size() */
+	inline int size() const { return (int)values.size(); }
+	inline T &operator[](int i) { return values[i]; }
+	inline const T &operator[](int i) const { return values[i]; }
+	inline uint64_t handleAt(int i) const {
+		uint32_t index = denseToSlot[i];
+		return makeHandle(index, slots[index].generation);
+	}
+
+	/* Slot access, for code that can only carry 32 bits per value */
+	static inline uint32_t slotOf(uint64_t handle) { return indexOf(handle); }
+
+	// 0 if nothing lives in the slot
+	inline uint64_t handleOfSlot(uint32_t index) const {
+		if (index >= slots.size() || !slots[index].alive) return 0;
+		return makeHandle(index, slots[index].generation);
+	}
+};
@@ -0,0 +1,71 @@
+/*************************************************************************/
+/*  spsc_queue.h                                                         */
+/*************************************************************************/
+/*                                                                       */
+/*       FMOD Studio module and bindings for the Godot game engine       */
+/*                                                                       */
+/*************************************************************************/
+/* Copyright (c) 2020 Alex Fonseka                                       */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Fixed-capacity, lock-free ring buffer for exactly one producer thread and one consumer thread.
+// Neither side ever blocks: push fails when the ring is full and pop fails when it is empty.
+// CAPACITY must be a power of two.
+template <class T, uint32_t CAPACITY>
+class SPSCQueue {
+	static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SPSCQueue capacity must be a power of two");
+	static const uint32_t MASK = CAPACITY - 1;
+
+	T buffer[CAPACITY];
+
+	// keep the two indices on separate cache lines so producer and consumer don't fight over one
+	alignas(64) std::atomic<uint32_t> head{ 0 }; // next slot to read, owned by the consumer
+	alignas(64) std::atomic<uint32_t> tail{ 0 }; // next slot to write, owned by the producer
+
+public:
+	/* Producer side */
+	bool push(const T &item) {
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == CAPACITY) return false;
+		buffer[t & MASK] = item;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* Consumer side */
+	bool pop(T &item) {
+		uint32_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire)) return false;
+		item = buffer[h & MASK];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const {
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+};